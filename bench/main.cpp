@@ -0,0 +1,201 @@
+// Scaled ECS workloads, run with: bench-libecrs [--json] [--sizes 10000,100000,1000000] [--repetitions 5]
+//  Prints one row per workload and size (CSV by default) so results can be diffed between releases
+
+#define ECRS_IMPLEMENTATION
+#include <ECRS/ecrs.hpp>
+#include <ECRS/adapter.hpp>
+#include <ECRS/parallel.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bench {
+
+	struct Position { float x, y, z; };
+	struct Velocity { float x, y, z; };
+	using Hashed = ecrs::hashtable::Storage<size_t>;
+
+	struct Result {
+		std::string_view name;
+		size_t entities;
+		std::vector<double> seconds; // One per repetition
+	};
+
+	struct Workload {
+		std::string_view name;
+		// Builds the module the measured step starts from (not timed)
+		void(*setup)(ecrs::Module& module, size_t n, std::mt19937_64& random);
+		// The measured step
+		void(*run)(ecrs::Module& module, size_t n, std::mt19937_64& random);
+	};
+
+	inline std::vector<ecrs::entity_t> shuffled_entities(size_t n, std::mt19937_64& random) {
+		std::vector<ecrs::entity_t> out(n);
+		std::iota(out.begin(), out.end(), ecrs::entity_t(1));
+		std::shuffle(out.begin(), out.end(), random);
+		return out;
+	}
+
+	inline void with_entities(ecrs::Module& module, size_t n, std::mt19937_64&) {
+		module.create_entities(n);
+	}
+	inline void with_positions(ecrs::Module& module, size_t n, std::mt19937_64& random) {
+		ecrs::entity_t first = module.create_entities(n);
+		for(ecrs::entity_t e = first; e < first + n; ++e)
+			module.add_component<Position>(e) = {float(e), 0, 0};
+	}
+	// Components are added in a random entity order so storages start out of order
+	inline void with_shuffled_components(ecrs::Module& module, size_t n, std::mt19937_64& random) {
+		std::uniform_real_distribution<float> value(-1000, 1000);
+		module.create_entities(n);
+		for(ecrs::entity_t e: shuffled_entities(n, random)) {
+			module.add_component<Position>(e) = {float(e), 0, 0};
+			module.add_component<Velocity>(e) = {1, 1, 1};
+			module.add_component<float>(e) = value(random);
+		}
+	}
+
+	static const Workload workloads[] = {
+		{"create", [](ecrs::Module&, size_t, std::mt19937_64&) {}, [](ecrs::Module& module, size_t n, std::mt19937_64&) {
+			for(size_t i = 0; i < n; ++i)
+				module.create_entity();
+		}},
+		{"add", with_entities, [](ecrs::Module& module, size_t n, std::mt19937_64&) {
+			for(ecrs::entity_t e = 1; e <= n; ++e)
+				module.add_component<Position>(e) = {float(e), 0, 0};
+		}},
+		{"get", with_positions, [](ecrs::Module& module, size_t n, std::mt19937_64&) {
+			volatile float sum = 0;
+			for(ecrs::entity_t e = 1; e <= n; ++e)
+				sum = sum + module.get_component<Position>(e).x;
+		}},
+		{"random_remove", with_positions, [](ecrs::Module& module, size_t n, std::mt19937_64& random) {
+			// NOTE: The shuffle is part of the measurement, it is small next to the removals
+			for(ecrs::entity_t e: shuffled_entities(n, random))
+				module.remove_component<Position>(e);
+		}},
+		{"release", with_positions, [](ecrs::Module& module, size_t n, std::mt19937_64& random) {
+			for(ecrs::entity_t e: shuffled_entities(n, random))
+				module.release_entity(e);
+		}},
+		{"sort_by_value", with_shuffled_components, [](ecrs::Module& module, size_t n, std::mt19937_64&) {
+			module.get_storage<float>().sort_by_value<float>(module);
+		}},
+		{"make_all_monotonic", with_shuffled_components, [](ecrs::Module& module, size_t n, std::mt19937_64&) {
+			module.make_all_monotonic();
+		}},
+		{"parallel_sort", with_shuffled_components, [](ecrs::Module& module, size_t n, std::mt19937_64&) {
+			ecrs::parallel::sort<float>(module, [](float* a, float* b) { return *a < *b; });
+		}},
+		{"parallel_make_all_monotonic", with_shuffled_components, [](ecrs::Module& module, size_t n, std::mt19937_64&) {
+			ecrs::parallel::make_all_monotonic(module);
+		}},
+		{"reorder_entities", with_shuffled_components, [](ecrs::Module& module, size_t n, std::mt19937_64& random) {
+			std::vector<size_t> order(module.entity_count());
+			std::iota(order.begin(), order.end(), 0);
+			std::shuffle(order.begin() + 1, order.end(), random); // Entity zero stays put
+			module.reorder_entities(fp_view_make(size_t, order.data(), order.size()));
+		}},
+		{"hashtable", with_entities, [](ecrs::Module& module, size_t n, std::mt19937_64&) {
+			for(ecrs::entity_t e = 1; e <= n; ++e)
+				ecrs::get_key_and_mark_occupied<size_t>(module.add_component<Hashed::component_type>(e)) = e;
+			auto& hashtable = ecrs::get_adapted_storage<Hashed>(module);
+			hashtable.rehash(module);
+			volatile size_t found = 0;
+			for(ecrs::entity_t e = 1; e <= n; ++e)
+				found = found + hashtable.find(e).has_value();
+		}},
+	};
+
+	inline Result measure(const Workload& workload, size_t n, size_t repetitions) {
+		Result out{workload.name, n};
+		for(size_t r = 0; r < repetitions; ++r) {
+			std::mt19937_64 random(r + 1);
+			ecrs::Module module;
+			workload.setup(module, n, random);
+			auto start = std::chrono::steady_clock::now();
+			workload.run(module, n, random);
+			auto end = std::chrono::steady_clock::now();
+			out.seconds.push_back(std::chrono::duration<double>(end - start).count());
+		}
+		return out;
+	}
+
+	struct Summary { double min, median, mean; };
+	inline Summary summarize(std::vector<double> seconds) {
+		std::sort(seconds.begin(), seconds.end());
+		return {seconds.front(), seconds[seconds.size() / 2], std::accumulate(seconds.begin(), seconds.end(), 0.0) / seconds.size()};
+	}
+
+	inline void print_csv(const std::vector<Result>& results) {
+		std::printf("workload,entities,repetitions,min_ns,median_ns,mean_ns,median_ns_per_entity\n");
+		for(auto& result: results) {
+			auto [min, median, mean] = summarize(result.seconds);
+			std::printf("%.*s,%zu,%zu,%.0f,%.0f,%.0f,%.3f\n", int(result.name.size()), result.name.data(), result.entities, result.seconds.size(),
+				min * 1e9, median * 1e9, mean * 1e9, median * 1e9 / result.entities);
+		}
+	}
+
+	inline void print_json(const std::vector<Result>& results) {
+		std::printf("{\"benchmarks\": [");
+		for(size_t i = 0; i < results.size(); ++i) {
+			auto& result = results[i];
+			auto [min, median, mean] = summarize(result.seconds);
+			std::printf("%s\n\t{\"workload\": \"%.*s\", \"entities\": %zu, \"repetitions\": %zu, \"min_ns\": %.0f, \"median_ns\": %.0f, \"mean_ns\": %.0f, \"median_ns_per_entity\": %.3f}",
+				i ? "," : "", int(result.name.size()), result.name.data(), result.entities, result.seconds.size(), min * 1e9, median * 1e9, mean * 1e9, median * 1e9 / result.entities);
+		}
+		std::printf("\n]}\n");
+	}
+
+	struct Options {
+		std::vector<size_t> sizes = {10'000, 100'000, 1'000'000};
+		size_t repetitions = 5;
+		bool json = false;
+		std::string_view filter; // Only run workloads whose name contains this
+	};
+
+	inline int run(const Options& options) {
+		std::vector<Result> results;
+		for(auto& workload: workloads) {
+			if(!options.filter.empty() && workload.name.find(options.filter) == std::string_view::npos) continue;
+			for(size_t n: options.sizes) {
+				results.push_back(measure(workload, n, options.repetitions));
+				std::fprintf(stderr, "%.*s/%zu done\n", int(workload.name.size()), workload.name.data(), n);
+			}
+		}
+		if(options.json) print_json(results);
+		else print_csv(results);
+		return 0;
+	}
+}
+
+int main(int argc, char** argv) {
+	bench::Options options;
+	for(int i = 1; i < argc; ++i) {
+		std::string_view arg = argv[i];
+		if(arg == "--json") options.json = true;
+		else if(arg == "--csv") options.json = false;
+		else if(arg == "--repetitions" && i + 1 < argc) options.repetitions = std::max<size_t>(std::stoull(argv[++i]), 1);
+		else if(arg == "--filter" && i + 1 < argc) options.filter = argv[++i];
+		else if(arg == "--sizes" && i + 1 < argc) {
+			options.sizes.clear();
+			for(std::string_view list = argv[++i]; !list.empty(); ) {
+				size_t comma = std::min(list.find(','), list.size());
+				options.sizes.push_back(std::stoull(std::string(list.substr(0, comma))));
+				list.remove_prefix(std::min(comma + 1, list.size()));
+			}
+		} else {
+			std::fprintf(stderr, "usage: %s [--csv | --json] [--sizes n,n,...] [--repetitions n] [--filter name]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	return bench::run(options);
+}
@@ -35,6 +35,158 @@ namespace ecrs {
 			inline const Tcomponent* data() const { return Base::data<Tcomponent>(); }
 			inline fp_view(Tcomponent) view() { return {data(), Base::size()}; }
 			inline fp_view(const Tcomponent) view() const { return {data(), Base::size()}; }
+			inline aligned_span<Tcomponent> aligned() { return Base::aligned<Tcomponent>(); }
+		};
+	}
+
+	// Structure of arrays adapter, stores each field of an aggregate T as its own component (field<T, I>) so loops which only touch one field only pull that field through cache
+	//  Every field storage holds the same entities in the same order (they are always added and removed together), thus a single index per entity addresses every field
+	//  NOTE: Sorting or reordering a single field's storage breaks that invariant, reorder them all the same way (make_monotonic on every field is fine)
+	namespace soa {
+		namespace detail {
+			struct any_field {
+				template<typename T>
+				operator T() const;
+			};
+
+			// Number of fields in the aggregate (NOTE: brace elision means array members are counted once per element, specialize fields for such types)
+			template<typename T, typename... Args>
+			constexpr size_t arity() {
+				if constexpr(requires { T{Args{}..., any_field{}}; }) return arity<T, Args..., any_field>();
+				else return sizeof...(Args);
+			}
+		}
+
+		// Exposes T's fields as a tuple of references, by default via structured bindings (aggregates with up to 8 fields)
+		//  Specialize with a static tie(U&) returning std::tie(...) of the fields to provide an explicit field list
+		template<typename T>
+		struct fields {
+			template<typename U>
+			static auto tie(U& v) {
+				constexpr size_t n = detail::arity<T>();
+				static_assert(n > 0 && n <= 8, "Aggregate has too many (or no) fields to reflect, specialize soa::fields");
+				if constexpr(n == 1) { auto& [a] = v; return std::tie(a); }
+				else if constexpr(n == 2) { auto& [a, b] = v; return std::tie(a, b); }
+				else if constexpr(n == 3) { auto& [a, b, c] = v; return std::tie(a, b, c); }
+				else if constexpr(n == 4) { auto& [a, b, c, d] = v; return std::tie(a, b, c, d); }
+				else if constexpr(n == 5) { auto& [a, b, c, d, e] = v; return std::tie(a, b, c, d, e); }
+				else if constexpr(n == 6) { auto& [a, b, c, d, e, f] = v; return std::tie(a, b, c, d, e, f); }
+				else if constexpr(n == 7) { auto& [a, b, c, d, e, f, g] = v; return std::tie(a, b, c, d, e, f, g); }
+				else { auto& [a, b, c, d, e, f, g, h] = v; return std::tie(a, b, c, d, e, f, g, h); }
+			}
+		};
+
+		template<typename T>
+		using tie_t = decltype(fields<T>::tie(std::declval<T&>()));
+		template<typename T>
+		constexpr static size_t field_count_v = std::tuple_size_v<tie_t<T>>;
+		template<typename T, size_t I>
+		using field_type_t = std::remove_reference_t<std::tuple_element_t<I, tie_t<T>>>;
+
+		// The component storing field I of T
+		template<typename T, size_t I, size_t Unique = 0>
+		struct field {
+			static constexpr size_t storage_alignment = std::max(alignof(field_type_t<T, I>), storage_alignment_v<T>); // Fields inherit any extra alignment T asks for
+			field_type_t<T, I> value;
+		};
+
+		// Proxy for an element spread across the field storages, converts to/assigns from T and supports structured bindings
+		template<typename T>
+		struct reference : public tie_t<T> {
+			using Base = tie_t<T>;
+			using Base::Base;
+			reference(const Base& b) : Base(b) {}
+
+			template<size_t I>
+			inline auto& get() const noexcept { return std::get<I>((const Base&)*this); }
+			inline operator T() const {
+				T out;
+				fields<T>::tie(out) = (const Base&)*this;
+				return out;
+			}
+			inline const reference& operator=(const T& value) const {
+				Base refs = *this;
+				refs = fields<T>::tie(value);
+				return *this;
+			}
+		};
+
+		template<typename T, size_t Unique = 0>
+		struct Storage {
+			static constexpr size_t field_count = field_count_v<T>;
+			template<size_t I>
+			using field_component = field<T, I, Unique>;
+			template<size_t I>
+			using field_type = field_type_t<T, I>;
+
+			TrivialModule* module;
+
+			Storage(TrivialModule& module) noexcept : module(&module) {
+				[&]<size_t... Is>(std::index_sequence<Is...>) {
+					(module.template get_storage<field_component<Is>>(), ...);
+				}(std::make_index_sequence<field_count>{});
+			}
+
+			template<size_t I = 0>
+			inline ecrs::Storage& storage() const noexcept { return module->template get_storage<field_component<I>>(); }
+			template<size_t I = 0>
+			inline static component_t component_id() noexcept { return get_global_component_id<field_component<I>>(); }
+
+			inline size_t size() const noexcept { return storage().size(); }
+			// Entity owning each index
+			inline std::span<const entity_t> entities() const noexcept { return {storage().entities, size()}; }
+
+			inline bool has(entity_t e) const noexcept { return module->has_component(e, component_id()); }
+			// Index of the entity's element in every field storage
+			inline size_t index(entity_t e) const noexcept {
+				assert(has(e));
+				return module->entity_component_indices[e][component_id()];
+			}
+
+			reference<T> add(entity_t e, const T& value = {}) noexcept {
+				auto values = fields<T>::tie(value);
+				[&]<size_t... Is>(std::index_sequence<Is...>) {
+					((module->template add_component<field_component<Is>>(e).value = std::get<Is>(values)), ...);
+				}(std::make_index_sequence<field_count>{});
+				return get(e);
+			}
+			// Adds T to every entity at once (values must be empty or have one value per entity)
+			void add(std::span<const entity_t> entities, std::span<const T> values = {}) noexcept {
+				assert(values.empty() || values.size() == entities.size());
+				[&]<size_t... Is>(std::index_sequence<Is...>) {
+					(module->template add_components<field_component<Is>>(entities), ...);
+				}(std::make_index_sequence<field_count>{});
+				for(size_t i = 0; i < values.size(); ++i)
+					get(entities[i]) = values[i];
+			}
+			bool remove(entity_t e) noexcept {
+				if(!has(e)) return false;
+				[&]<size_t... Is>(std::index_sequence<Is...>) {
+					(module->template remove_component<field_component<Is>>(e), ...);
+				}(std::make_index_sequence<field_count>{});
+				return true;
+			}
+
+			inline reference<T> get(entity_t e) const noexcept { return at(index(e)); }
+			inline reference<T> at(size_t index) const noexcept {
+				return [&]<size_t... Is>(std::index_sequence<Is...>) {
+					assert(((storage<Is>().entities[index] == entities()[index]) && ...)); // Field storages have fallen out of step
+					return reference<T>(typename reference<T>::Base(storage<Is>().template get<field_component<Is>>(index).value...));
+				}(std::make_index_sequence<field_count>{});
+			}
+
+			// Contiguous array of field I for every element (in index order)
+			template<size_t I>
+			inline std::span<field_type<I>> span() const noexcept {
+				static_assert(sizeof(field_component<I>) == sizeof(field_type<I>));
+				return {(field_type<I>*)storage<I>().template data<field_component<I>>(), size()};
+			}
+			template<size_t I>
+			inline aligned_span<field_type<I>> aligned() const noexcept {
+				static_assert(sizeof(field_component<I>) == sizeof(field_type<I>));
+				auto out = storage<I>().template aligned<field_component<I>>();
+				return {(field_type<I>*)out.data, out.size, out.padded_size, out.alignment};
+			}
 		};
 	}
 
@@ -222,6 +374,8 @@ namespace ecrs {
 			}
 
 			bool rehash(TrivialModule& module, size_t retries, bool resized = false) {
+				ECRS_ZONE_SCOPED_NAMED("ecrs::hashtable::Storage::rehash");
+				ECRS_COUNT(Rehashes);
 				// Clear the neighborhood information
 				auto data = Base::data();
 				size_t size = Base::size(), half = size / 2;
@@ -336,4 +490,10 @@ namespace ecrs {
 	using hashtable::get_value;
 }
 
+// Structured bindings for soa::reference
+template<typename T>
+struct std::tuple_size<ecrs::soa::reference<T>> : public std::tuple_size<ecrs::soa::tie_t<T>> {};
+template<size_t I, typename T>
+struct std::tuple_element<I, ecrs::soa::reference<T>> : public std::tuple_element<I, ecrs::soa::tie_t<T>> {};
+
 #endif // __ECS_ADAPTER_HPP__
\ No newline at end of file
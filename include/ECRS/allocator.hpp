@@ -0,0 +1,205 @@
+#pragma once
+
+// NOTE: When ECRS_ENABLE_ALLOCATORS is defined this header must be included before any libfp header (component_id.hpp includes it first)
+//  so that every fp dynarray allocates through ecrs_allocation_function (ecrs::allocator::Hook checks that libfp honours FP_ALLOCATION_FUNCTION)
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <utility>
+
+namespace ecrs {
+
+	// Source of the memory behind fp dynarrays (storages, entity indices, freelists, relations, etc...)
+	struct Allocator {
+		virtual ~Allocator() = default;
+		virtual void* allocate(size_t size) noexcept = 0;
+		virtual void deallocate(void* ptr, size_t size) noexcept = 0;
+	};
+
+	struct HeapAllocator : public Allocator {
+		void* allocate(size_t size) noexcept override { return std::malloc(size); }
+		void deallocate(void* ptr, size_t size) noexcept override { std::free(ptr); }
+
+		static HeapAllocator& instance() noexcept {
+			static HeapAllocator heap;
+			return heap;
+		}
+	};
+
+	// Bump allocator, deallocating is a no-op and reset releases everything at once (tearing down a module becomes a single reset)
+	struct ArenaAllocator : public Allocator {
+		static constexpr size_t alignment = 16;
+		struct Block {
+			Block* next;
+			size_t size, used;
+		};
+
+		Allocator& upstream;
+		size_t block_size;
+		Block* blocks = nullptr;
+		std::mutex mutex;
+
+		ArenaAllocator(size_t block_size = 1024 * 1024, Allocator& upstream = HeapAllocator::instance()) noexcept : upstream(upstream), block_size(block_size) {}
+		ArenaAllocator(const ArenaAllocator&) = delete;
+		ArenaAllocator& operator=(const ArenaAllocator&) = delete;
+		~ArenaAllocator() { reset(); }
+
+		void* allocate(size_t size) noexcept override {
+			std::lock_guard lock(mutex);
+			size = (size + alignment - 1) & ~(alignment - 1);
+			if(!blocks || blocks->used + size > blocks->size) {
+				size_t capacity = std::max(block_size, size);
+				auto block = (Block*)upstream.allocate(sizeof(Block) + alignment + capacity);
+				if(!block) return nullptr;
+				*block = {blocks, capacity, 0};
+				blocks = block;
+			}
+			void* out = data(blocks) + blocks->used;
+			blocks->used += size;
+			return out;
+		}
+		void deallocate(void* ptr, size_t size) noexcept override {}
+
+		// Frees every block (and thus everything allocated from the arena)
+		void reset() noexcept {
+			std::lock_guard lock(mutex);
+			while(blocks) {
+				Block* next = blocks->next;
+				upstream.deallocate(blocks, sizeof(Block) + alignment + blocks->size);
+				blocks = next;
+			}
+		}
+
+		// Bytes handed out since the last reset
+		size_t used() const noexcept {
+			size_t out = 0;
+			for(Block* block = blocks; block; block = block->next)
+				out += block->used;
+			return out;
+		}
+
+	protected:
+		static inline uint8_t* data(Block* block) noexcept {
+			auto address = (uintptr_t)(block + 1);
+			return (uint8_t*)((address + alignment - 1) & ~(alignment - 1));
+		}
+	};
+
+	// Forwards to another allocator while keeping track of how much memory is in use
+	struct CountingAllocator : public Allocator {
+		Allocator& upstream;
+		std::atomic<size_t> live = 0, peak = 0, allocations = 0, deallocations = 0;
+
+		CountingAllocator(Allocator& upstream = HeapAllocator::instance()) noexcept : upstream(upstream) {}
+
+		void* allocate(size_t size) noexcept override {
+			size_t now = live.fetch_add(size, std::memory_order_relaxed) + size;
+			for(size_t previous = peak.load(std::memory_order_relaxed); previous < now && !peak.compare_exchange_weak(previous, now, std::memory_order_relaxed); );
+			allocations.fetch_add(1, std::memory_order_relaxed);
+			return upstream.allocate(size);
+		}
+		void deallocate(void* ptr, size_t size) noexcept override {
+			live.fetch_sub(size, std::memory_order_relaxed);
+			deallocations.fetch_add(1, std::memory_order_relaxed);
+			upstream.deallocate(ptr, size);
+		}
+	};
+
+	struct AllocationTally;
+
+	namespace detail {
+		// Placed before every allocation so it can always be returned to the allocator which made it
+		struct alignas(16) AllocationHeader {
+			Allocator* owner;
+			size_t size;
+		};
+
+		inline thread_local Allocator* current_allocator = nullptr;
+		inline thread_local AllocationTally* current_tally = nullptr;
+	}
+
+	// The allocator new allocations on this thread come from
+	inline Allocator& current_allocator() noexcept {
+		return detail::current_allocator ? *detail::current_allocator : HeapAllocator::instance();
+	}
+
+	// Makes an allocator current on this thread for its lifetime
+	//  Memory remembers which allocator it came from, so growing or freeing it later (even outside of the scope) goes back to the same allocator
+	struct AllocatorScope {
+		Allocator* previous;
+		AllocatorScope(Allocator& allocator) noexcept : previous(std::exchange(detail::current_allocator, &allocator)) {}
+		~AllocatorScope() noexcept { detail::current_allocator = previous; }
+	};
+
+	// Counts the allocations (and growths) made on this thread while it is installed, used to verify hot paths never touch the heap
+	//  NOTE: Only sees fp dynarrays when ECRS_ENABLE_ALLOCATORS is defined (anything else, like operator new, must report to it explicitly)
+	struct AllocationTally {
+		size_t allocations = 0, bytes = 0;
+		AllocationTally* previous;
+
+		AllocationTally() noexcept : previous(std::exchange(detail::current_tally, this)) {}
+		AllocationTally(const AllocationTally&) = delete;
+		AllocationTally& operator=(const AllocationTally&) = delete;
+		~AllocationTally() noexcept { detail::current_tally = previous; }
+
+		static inline void record(size_t size) noexcept {
+			if(auto tally = detail::current_tally) {
+				++tally->allocations;
+				tally->bytes += size;
+			}
+		}
+	};
+
+	// realloc compatible entry point (a size of zero frees)
+	inline void* reallocate(void* ptr, size_t size) noexcept {
+		using detail::AllocationHeader;
+		if(!ptr) {
+			if(size == 0) return nullptr;
+			AllocationTally::record(size);
+			Allocator& allocator = current_allocator();
+			auto header = (AllocationHeader*)allocator.allocate(sizeof(AllocationHeader) + size);
+			if(!header) return nullptr;
+			*header = {&allocator, size};
+			return header + 1;
+		}
+
+		auto header = (AllocationHeader*)ptr - 1;
+		Allocator& owner = *header->owner;
+		if(size == 0) {
+			owner.deallocate(header, sizeof(AllocationHeader) + header->size);
+			return nullptr;
+		}
+		if(size <= header->size) return ptr; // Shrinking keeps the block
+
+		AllocationTally::record(size);
+		auto grown = (AllocationHeader*)owner.allocate(sizeof(AllocationHeader) + size);
+		if(!grown) return nullptr;
+		*grown = {&owner, size};
+		std::memcpy(grown + 1, ptr, header->size);
+		owner.deallocate(header, sizeof(AllocationHeader) + header->size);
+		return grown + 1;
+	}
+}
+
+#ifdef ECRS_ENABLE_ALLOCATORS
+	extern "C" void* ecrs_allocation_function(void* ptr, size_t size) noexcept
+	#ifdef ECRS_IMPLEMENTATION
+	{ return ecrs::reallocate(ptr, size); }
+	#else
+	;
+	#endif
+
+	#define FP_ALLOCATION_FUNCTION ecrs_allocation_function
+	// Global (process lifetime) allocations shouldn't end up in whatever arena happens to be current
+	#define ECRS_GLOBAL_ALLOCATION_SCOPE ecrs::AllocatorScope __ecrs_global_allocation_scope(ecrs::HeapAllocator::instance())
+	// Arrays created or grown in the rest of the block come from allocator (an Allocator*, the thread's current allocator if null)
+	#define ECRS_ALLOCATION_SCOPE(allocator) ecrs::AllocatorScope __ecrs_allocation_scope((allocator) ? *(allocator) : ecrs::current_allocator())
+#else
+	#define ECRS_GLOBAL_ALLOCATION_SCOPE
+	#define ECRS_ALLOCATION_SCOPE(allocator) ((void)0)
+#endif
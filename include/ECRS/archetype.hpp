@@ -0,0 +1,367 @@
+#pragma once
+
+#include "ecs.hpp"
+
+namespace ecrs::archetype {
+
+	// A table of every entity which has exactly the same set of components, each component is stored in its own column
+	struct Archetype {
+		struct Edge {
+			component_t component;
+			size_t add = Storage::invalid; // Archetype reached by adding component
+			size_t remove = Storage::invalid; // Archetype reached by removing component
+		};
+
+		fp_dynarray(component_t) components = nullptr; // Sorted
+		fp_dynarray(Storage) columns = nullptr; // Parallel to components (tags have an uninitialized column which holds no data)
+		fp_dynarray(entity_t) entities = nullptr; // Row -> entity
+		fp_dynarray(Edge) edges = nullptr; // Cached transitions to neighboring archetypes
+
+		inline void free() noexcept {
+			if(components) fpda_free_and_null(components);
+			if(columns) {
+				fpda_iterate(columns)
+					i->~Storage();
+				fpda_free_and_null(columns);
+			}
+			if(entities) fpda_free_and_null(entities);
+			if(edges) fpda_free_and_null(edges);
+		}
+
+		inline size_t size() const noexcept { return fpda_size(entities); }
+		inline bool empty() const noexcept { return size() == 0; }
+
+		// Finds which column stores component (or Storage::invalid if this archetype doesn't have component)
+		inline size_t column(component_t component) const noexcept {
+			auto begin = components, end = components + fpda_size(components);
+			auto found = std::lower_bound(begin, end, component);
+			if(found == end || *found != component) return Storage::invalid;
+			return found - begin;
+		}
+		inline bool has_component(component_t component) const noexcept { return column(component) != Storage::invalid; }
+
+		inline bool matches(const component_t* sorted, size_t count) const noexcept {
+			return fpda_size(components) == count && (count == 0 || std::equal(components, components + count, sorted));
+		}
+
+		inline Edge& edge(component_t component) noexcept {
+			fp_iterate_named(edges, edge)
+				if(edge->component == component)
+					return *edge;
+			fpda_push_back(edges, Edge{component});
+			return edges[fpda_size(edges) - 1];
+		}
+
+		inline void* get(size_t column, size_t row) noexcept {
+			assert(row < size());
+			return columns[column].get(row);
+		}
+		inline const void* get(size_t column, size_t row) const noexcept {
+			assert(row < size());
+			return columns[column].get(row);
+		}
+
+		// Adds a zero initialized row, returns its index
+		inline size_t push_back(entity_t e) noexcept {
+			size_t row = size();
+			fp_iterate_named(columns, column)
+				if(column->element_size != Storage::invalid)
+					column->allocate();
+			fpda_push_back(entities, e);
+			return row;
+		}
+
+		// Swaps the last row into row (without running any destructors), returns the entity which got moved into row
+		inline entity_t swap_remove(size_t row) noexcept {
+			assert(row < size());
+			fp_iterate_named(columns, column)
+				if(column->element_size != Storage::invalid) {
+					column->swap(row);
+					column->pop_back();
+				}
+			entity_t moved = entities[size() - 1];
+			entities[row] = moved;
+			fpda_pop_back(entities);
+			return moved;
+		}
+	};
+
+	// A module which groups entities with identical component sets into column tables,
+	//  making iteration over entities with several components a linear walk over contiguous memory
+	struct TrivialModule {
+		struct Record {
+			index_t archetype = Storage::invalid_index;
+			index_t row = Storage::invalid_index;
+		};
+
+		fp_dynarray(Archetype) archetypes = nullptr; // The first archetype is always the empty archetype
+		fp_dynarray(Record) records = nullptr; // Entity -> location
+		fp_dynarray(size_t) component_sizes = nullptr; // Component -> element size (zero for tags)
+		fp_dynarray(size_t) component_alignments = nullptr; // Component -> alignment its columns guarantee (see storage_alignment)
+		fp_dynarray(entity_t) freelist = nullptr;
+
+		inline void free() {
+			if(archetypes) {
+				fpda_iterate(archetypes)
+					i->free();
+				fpda_free_and_null(archetypes);
+			}
+			if(records) fpda_free_and_null(records);
+			if(component_sizes) fpda_free_and_null(component_sizes);
+			if(component_alignments) fpda_free_and_null(component_alignments);
+			if(freelist) fpda_free_and_null(freelist);
+		}
+
+		size_t entity_count() const { return fpda_size(records); }
+		size_t archetype_count() const { return fpda_size(archetypes); }
+
+		void register_component(component_t componentID, size_t element_size, size_t alignment = 0) noexcept {
+			if(fpda_size(component_sizes) <= componentID) {
+				fpda_grow_to_size_and_initialize(component_sizes, componentID + 1, Storage::invalid);
+				fpda_grow_to_size_and_initialize(component_alignments, componentID + 1, 0);
+			}
+			assert(component_sizes[componentID] == Storage::invalid || component_sizes[componentID] == element_size);
+			component_sizes[componentID] = element_size;
+			component_alignments[componentID] = std::max(component_alignments[componentID], alignment);
+		}
+		template<typename T, size_t Unique = 0>
+		inline component_t register_component() noexcept {
+			component_t componentID = get_global_component_id<T, Unique>();
+			if constexpr(is_tag_v<T>) register_component(componentID, 0);
+			else register_component(componentID, sizeof(T), storage_alignment_v<T>);
+			return componentID;
+		}
+
+		// Finds (or creates) the archetype with exactly the provided sorted set of components
+		size_t find_or_create_archetype(const component_t* sorted, size_t count) noexcept {
+			fp_iterate_named(archetypes, archetype)
+				if(archetype->matches(sorted, count))
+					return fp_iterate_calculate_index(archetypes, archetype);
+
+			Archetype archetype;
+			for(size_t i = 0; i < count; ++i) {
+				assert(fpda_size(component_sizes) > sorted[i] && component_sizes[sorted[i]] != Storage::invalid);
+				fpda_push_back(archetype.components, sorted[i]);
+				fpda_grow(archetype.columns, 1);
+				if(size_t size = component_sizes[sorted[i]]; size > 0)
+					new(archetype.columns + i) Storage(size, 16, component_alignments[sorted[i]]);
+				else new(archetype.columns + i) Storage();
+			}
+			fpda_push_back(archetypes, archetype);
+			return fpda_size(archetypes) - 1;
+		}
+
+		// Finds the archetype reached by adding (or removing) component from archetype, caching the result
+		size_t transition(size_t archetype, component_t component, bool add) noexcept {
+			{
+				auto& edge = archetypes[archetype].edge(component);
+				if(size_t target = add ? edge.add : edge.remove; target != Storage::invalid)
+					return target;
+			}
+
+			auto& source = archetypes[archetype];
+			size_t count = fpda_size(source.components);
+			component_t* sorted = fp_alloca(component_t, count + 1);
+			size_t size = 0;
+			for(size_t i = 0; i < count; ++i) {
+				if(add && source.components[i] > component && (size == 0 || sorted[size - 1] < component))
+					sorted[size++] = component;
+				if(!add && source.components[i] == component) continue;
+				sorted[size++] = source.components[i];
+			}
+			if(add && (size == 0 || sorted[size - 1] < component))
+				sorted[size++] = component;
+
+			size_t target = find_or_create_archetype(sorted, size); // NOTE: May reallocate archetypes
+			auto& edge = archetypes[archetype].edge(component);
+			(add ? edge.add : edge.remove) = target;
+			// The reverse transition is now known as well
+			auto& reverse = archetypes[target].edge(component);
+			(add ? reverse.remove : reverse.add) = archetype;
+			return target;
+		}
+
+		// Moves e into the target archetype, components shared by both archetypes are carried over (relocated bytewise)
+		void move_entity(entity_t e, size_t target) noexcept {
+			auto record = records[e];
+			if(record.archetype == target) return;
+
+			auto& dest = archetypes[target];
+			size_t row = dest.push_back(e);
+			if(record.archetype != Storage::invalid_index) {
+				auto& source = archetypes[record.archetype];
+				for(size_t c = 0, size = fpda_size(dest.components); c < size; ++c) {
+					if(dest.columns[c].element_size == Storage::invalid) continue;
+					if(size_t column = source.column(dest.components[c]); column != Storage::invalid)
+						std::memcpy(dest.get(c, row), source.get(column, record.row), dest.columns[c].element_size);
+				}
+
+				entity_t moved = source.swap_remove(record.row);
+				if(moved != e) records[moved].row = record.row;
+			}
+			records[e] = {index_t(target), index_t(row)};
+		}
+
+		entity_t create_entity() noexcept {
+			if(!archetypes) find_or_create_archetype(nullptr, 0);
+
+			entity_t e;
+			if(!freelist || fpda_empty(freelist)) {
+				e = fpda_size(records);
+				if(e == 0) {
+					fpda_push_back(records, Record{}); // Skip entity zero!
+					++e;
+				}
+				fpda_push_back(records, Record{});
+			} else e = *fpda_pop_back(freelist);
+
+			move_entity(e, 0);
+			return e;
+		}
+
+		bool release_entity(entity_t e, bool clearMemory = true) noexcept {
+			if(e >= fpda_size(records) || records[e].archetype == Storage::invalid_index) return false;
+
+			auto record = records[e];
+			entity_t moved = archetypes[record.archetype].swap_remove(record.row);
+			if(moved != e) records[moved].row = record.row;
+			records[e] = {};
+
+			fpda_push_back(freelist, e);
+			return true;
+		}
+
+		void* add_component(entity_t e, component_t componentID, size_t element_size, size_t alignment = 0) noexcept {
+			assert(e < fpda_size(records) && records[e].archetype != Storage::invalid_index);
+			register_component(componentID, element_size, alignment);
+			if(!has_component(e, componentID))
+				move_entity(e, transition(records[e].archetype, componentID, true));
+			return get_component(e, componentID);
+		}
+		template<typename T, size_t Unique = 0>
+		T& add_component(entity_t e) noexcept {
+			assert(e < fpda_size(records) && records[e].archetype != Storage::invalid_index);
+			component_t componentID = register_component<T, Unique>();
+			if(has_component(e, componentID))
+				return get_component<T, Unique>(e);
+
+			move_entity(e, transition(records[e].archetype, componentID, true));
+			if constexpr(is_tag_v<T>) return detail::tag_value<T>();
+			else {
+				auto& res = *new(get_component(e, componentID)) T();
+				if constexpr(detail::is_with_entity_v<T>)
+					res.entity = e;
+				return res;
+			}
+		}
+
+		bool remove_component(entity_t e, component_t componentID) noexcept {
+			if(!has_component(e, componentID)) return false;
+			move_entity(e, transition(records[e].archetype, componentID, false));
+			return true;
+		}
+		template<typename Tcomponent, size_t Unique = 0>
+		inline bool remove_component(entity_t e) noexcept {
+			return remove_component(e, get_global_component_id<Tcomponent, Unique>());
+		}
+
+		inline bool has_component(entity_t e, component_t componentID) const noexcept {
+			return fpda_size(records) > e && records[e].archetype != Storage::invalid_index
+				&& archetypes[records[e].archetype].has_component(componentID);
+		}
+		template<typename T, size_t Unique = 0>
+		inline bool has_component(entity_t e) const noexcept {
+			return has_component(e, get_global_component_id<T, Unique>());
+		}
+
+		void* get_component(entity_t e, component_t componentID) noexcept {
+			assert(has_component(e, componentID));
+			auto& archetype = archetypes[records[e].archetype];
+			size_t column = archetype.column(componentID);
+			if(archetype.columns[column].element_size == Storage::invalid) return nullptr; // Tags don't have any data
+			return archetype.get(column, records[e].row);
+		}
+		const void* get_component(entity_t e, component_t componentID) const noexcept {
+			assert(has_component(e, componentID));
+			auto& archetype = archetypes[records[e].archetype];
+			size_t column = archetype.column(componentID);
+			if(archetype.columns[column].element_size == Storage::invalid) return nullptr; // Tags don't have any data
+			return archetype.get(column, records[e].row);
+		}
+		template<typename T, size_t Unique = 0>
+		T& get_component(entity_t e) noexcept {
+			if constexpr (is_tag_v<T>) return detail::tag_value<T>();
+			else return *(T*)get_component(e, get_global_component_id<T, Unique>());
+		}
+		template<typename T, size_t Unique = 0>
+		const T& get_component(entity_t e) const noexcept {
+			if constexpr (is_tag_v<T>) return detail::tag_value<T>();
+			else return *(const T*)get_component(e, get_global_component_id<T, Unique>());
+		}
+
+		void* get_or_add_component(entity_t e, component_t componentID, size_t element_size) noexcept {
+			return add_component(e, componentID, element_size); // NOTE: add_component returns the existing component if there is one
+		}
+		template<typename T, size_t Unique = 0>
+		T& get_or_add_component(entity_t e) noexcept {
+			return add_component<T, Unique>(e); // NOTE: add_component returns the existing component if there is one
+		}
+
+		// Calls f(entity, Tcomponents&...) for every entity which has all of Tcomponents, walking each matching archetype's columns linearly
+		template<typename... Tcomponents, typename F>
+		void for_each(const F& f) {
+			component_t ids[] = {get_global_component_id<Tcomponents>()...};
+			fp_iterate_named(archetypes, archetype) {
+				if(archetype->empty()) continue;
+				size_t columns[sizeof...(Tcomponents)];
+				bool matches = true;
+				for(size_t i = 0; i < sizeof...(Tcomponents); ++i)
+					if((columns[i] = archetype->column(ids[i])) == Storage::invalid) {
+						matches = false;
+						break;
+					}
+				if(!matches) continue;
+
+				[&, this]<std::size_t... I>(std::index_sequence<I...>) {
+					auto data = std::make_tuple(column_data<Tcomponents>(*archetype, columns[I])...);
+					for(size_t row = 0, size = archetype->size(); row < size; ++row)
+						f(archetype->entities[row], column_access<Tcomponents>(std::get<I>(data), row)...);
+				}(std::make_index_sequence<sizeof...(Tcomponents)>{});
+			}
+		}
+
+	protected:
+		template<typename T>
+		static inline T* column_data(Archetype& archetype, size_t column) noexcept {
+			if constexpr(is_tag_v<T>) return &detail::tag_value<T>();
+			else return archetype.columns[column].template data<T>();
+		}
+		template<typename T>
+		static inline T& column_access(T* data, size_t row) noexcept {
+			if constexpr(is_tag_v<T>) return *data;
+			else return data[row];
+		}
+	};
+
+	struct Module : public TrivialModule {
+		bool should_leak = false; // Useful when shutting down, if we are closing we can just leave memory cleanup to the operating system for a bit of added performance!
+
+		Module() = default;
+		Module(const Module&) = delete; // Storages need to become copyable to change this...
+		Module(Module&& o) { *this = std::move(o); }
+		Module& operator=(const Module& o) = delete;
+		Module& operator=(Module&& o) {
+			free();
+			archetypes = std::exchange(o.archetypes, nullptr);
+			records = std::exchange(o.records, nullptr);
+			component_sizes = std::exchange(o.component_sizes, nullptr);
+			component_alignments = std::exchange(o.component_alignments, nullptr);
+			freelist = std::exchange(o.freelist, nullptr);
+			return *this;
+		}
+
+		~Module() {
+			if(!should_leak) free();
+		}
+	};
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#include "ecs.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ecrs {
+
+	// Records structural changes (entity creation/release, component addition/removal) to apply to a module later
+	//  Useful while iterating or from worker threads (give each thread its own buffer, they aren't thread safe)
+	//  NOTE: Commands are applied in phases (every create, then every add and remove, then every release) not in the order they were recorded
+	//   When several adds/removes of one component are recorded for an entity only the last one takes effect
+	struct CommandBuffer {
+		static constexpr entity_t placeholder_bit = entity_t(1) << (sizeof(entity_t) * 8 - 1);
+		static constexpr size_t no_payload = std::numeric_limits<size_t>::max();
+
+		enum class Type : uint8_t {
+			Create,
+			Add,
+			Remove,
+			Release,
+		};
+		struct Command {
+			Type type;
+			entity_t entity;
+			component_t component = 0;
+			size_t element_size = 0; // Zero for tags (and unused by anything but adds)
+			size_t payload = no_payload; // Offset of the component's bytes in the arena
+			size_t alignment = 0; // Alignment of the component's storage (zero for the default)
+			void(*set_entity)(TrivialModule&, void*, entity_t) = nullptr; // Set for with_entity components
+		};
+
+		fp_dynarray(Command) commands = nullptr;
+		fp_dynarray(uint8_t) arena = nullptr; // Component payloads, copied bytewise
+		fp_dynarray(entity_t) resolved = nullptr; // Real entities of the placeholders created by the last flush
+		size_t placeholders = 0; // Placeholders handed out so far, they are never reused so stale ones can be detected
+		size_t batch_start = 0; // First placeholder handed out since the last flush
+		size_t resolved_start = 0; // First placeholder created by the last flush
+
+		CommandBuffer() = default;
+		CommandBuffer(const CommandBuffer&) = delete;
+		CommandBuffer(CommandBuffer&& o) { *this = std::move(o); }
+		CommandBuffer& operator=(const CommandBuffer&) = delete;
+		CommandBuffer& operator=(CommandBuffer&& o) {
+			free();
+			commands = std::exchange(o.commands, nullptr);
+			arena = std::exchange(o.arena, nullptr);
+			resolved = std::exchange(o.resolved, nullptr);
+			placeholders = std::exchange(o.placeholders, 0);
+			batch_start = std::exchange(o.batch_start, 0);
+			resolved_start = std::exchange(o.resolved_start, 0);
+			return *this;
+		}
+		~CommandBuffer() { free(); }
+
+		inline void free() {
+			if(commands) fpda_free_and_null(commands);
+			if(arena) fpda_free_and_null(arena);
+			if(resolved) fpda_free_and_null(resolved);
+			placeholders = batch_start = resolved_start = 0;
+		}
+		// NOTE: Placeholders handed out since the last flush can't be used after clearing
+		inline void clear() {
+			if(commands) fpda_clear(commands);
+			if(arena) fpda_clear(arena);
+			batch_start = placeholders;
+		}
+		inline bool empty() const noexcept { return fpda_empty(commands); }
+
+		static inline bool is_placeholder(entity_t e) noexcept { return e & placeholder_bit; }
+		// Gets the real entity a placeholder (returned by create_entity) became during the last flush (invalid_entity for placeholders it didn't create)
+		inline entity_t resolve(entity_t e) const noexcept {
+			if(!is_placeholder(e)) return e;
+			size_t placeholder = e & ~placeholder_bit;
+			if(placeholder < resolved_start || placeholder - resolved_start >= fpda_size(resolved)) return invalid_entity;
+			return resolved[placeholder - resolved_start];
+		}
+
+		// Returns a placeholder entity which can be used in the other commands of this buffer (and passed to resolve after flushing)
+		entity_t create_entity() noexcept {
+			entity_t e = placeholder_bit | placeholders++;
+			fpda_push_back(commands, (Command{Type::Create, e}));
+			return e;
+		}
+		void release_entity(entity_t e) noexcept {
+			fpda_push_back(commands, (Command{Type::Release, e}));
+		}
+
+		// Copies element_size bytes from data (or zeros if null) as the component's value, replacing the value if the entity already has the component
+		//  alignment is only used if the flush creates the component's storage
+		void add_component(entity_t e, component_t componentID, size_t element_size, const void* data = nullptr, size_t alignment = 0) noexcept {
+			assert(element_size != Storage::invalid);
+			size_t payload = fpda_size(arena);
+			fpda_grow(arena, element_size);
+			if(data) std::memcpy(arena + payload, data, element_size);
+			else std::memset(arena + payload, 0, element_size);
+			fpda_push_back(commands, (Command{Type::Add, e, componentID, element_size, payload, alignment}));
+		}
+		template<typename T, size_t Unique = 0>
+		void add_component(entity_t e, const T& value = {}) noexcept {
+			static_assert(std::is_trivially_copyable_v<T>, "Command buffers copy payloads bytewise");
+			component_t componentID = get_global_component_id<T, Unique>();
+			if constexpr(is_tag_v<T>)
+				fpda_push_back(commands, (Command{Type::Add, e, componentID, 0}));
+			else {
+				add_component(e, componentID, sizeof(T), &value, storage_alignment_v<T>);
+				if constexpr(detail::is_with_entity_v<T>)
+					commands[fpda_size(commands) - 1].set_entity = [](TrivialModule& module, void* component, entity_t e) {
+						((T*)component)->set_entity(module, e);
+					};
+			}
+		}
+
+		void remove_component(entity_t e, component_t componentID) noexcept {
+			fpda_push_back(commands, (Command{Type::Remove, e, componentID}));
+		}
+		template<typename T, size_t Unique = 0>
+		inline void remove_component(entity_t e) noexcept { remove_component(e, get_global_component_id<T, Unique>()); }
+
+		// Applies every recorded command to the module and clears the buffer, returns how many commands were rejected
+		//  Adds and removes are applied grouped by component (and sorted by entity within a component) so each storage is grown once and touched in order
+		//  NOTE: Commands which refer to a placeholder from before the last flush are rejected, the entity it stood for can't be known any more
+		size_t flush(TrivialModule& module) noexcept {
+			size_t size = fpda_size(commands);
+			if(size == 0) {
+				clear();
+				return 0;
+			}
+
+			// Create the real entities
+			if(resolved) fpda_clear(resolved);
+			fpda_reserve(resolved, placeholders - batch_start);
+			resolved_start = batch_start;
+			fp_iterate_named(commands, command)
+				if(command->type == Type::Create)
+					fpda_push_back(resolved, module.create_entity());
+
+			// Sort the remaining commands into phases, by component within each phase and by entity within each component
+			//  NOTE: The sort is stable so commands for the same entity and component stay in the order they were recorded
+			ScratchArena& scratch = module.scratch_arena();
+			ScratchArena::Scope scope(scratch);
+			size_t* order = ECRS_SCRATCH(scratch, size_t, size);
+			size_t accepted = 0;
+			for(size_t i = 0; i < size; ++i)
+				if((commands[i].entity = resolve(commands[i].entity)) != invalid_entity)
+					order[accepted++] = i;
+			std::stable_sort(order, order + accepted, [this](size_t _a, size_t _b) {
+				const Command& a = commands[_a];
+				const Command& b = commands[_b];
+				if(phase(a.type) != phase(b.type)) return phase(a.type) < phase(b.type);
+				if(a.type == Type::Release) return a.entity < b.entity;
+				if(a.component != b.component) return a.component < b.component;
+				return a.entity < b.entity;
+			});
+
+			for(size_t i = 0; i < accepted; ) {
+				const Command& first = commands[order[i]];
+				size_t end = i + 1;
+				while(end < accepted && phase(commands[order[end]].type) == phase(first.type)
+					&& (first.type == Type::Release || commands[order[end]].component == first.component)) ++end;
+
+				if(first.type == Type::Add || first.type == Type::Remove)
+					apply_changes(module, order + i, end - i);
+				else if(first.type == Type::Release)
+					for(size_t j = i; j < end; ++j)
+						module.release_entity(commands[order[j]].entity);
+				// NOTE: Creates were already handled above
+				i = end;
+			}
+			clear();
+			return size - accepted;
+		}
+
+	protected:
+		// Adds and removes share a phase so they can be ordered against each other
+		static inline Type phase(Type type) noexcept { return type == Type::Remove ? Type::Add : type; }
+
+		// Applies a run of adds and removes which all target the same component, an entity's last recorded command supersedes the ones before it
+		void apply_changes(TrivialModule& module, const size_t* order, size_t count) noexcept {
+			component_t component = commands[*order].component;
+			auto superseded = [&](size_t i) { return i + 1 < count && commands[order[i + 1]].entity == commands[order[i]].entity; };
+
+			// Grow the storage once for every element we are about to add
+			Storage* storage = nullptr;
+			size_t adds = 0;
+			for(size_t i = 0; i < count; ++i)
+				if(const Command& command = commands[order[i]]; command.type == Type::Add && command.element_size && !superseded(i)) {
+					if(!storage) storage = &module.get_storage(component, command.element_size, command.alignment);
+					++adds;
+				}
+			if(storage) storage->reserve(storage->size() + adds);
+
+			for(size_t i = 0; i < count; ++i) {
+				if(superseded(i)) continue;
+				const Command& command = commands[order[i]];
+				if(command.type == Type::Remove) {
+					if(!module.has_component(command.entity, component)) continue;
+					if(module.is_tag(component)) module.set_tag(command.entity, component, false);
+					else module.remove_component(command.entity, component);
+				} else if(command.element_size == 0) // Tags only need their bit set
+					module.set_tag(command.entity, component);
+				else {
+					assert(command.element_size == storage->element_size);
+					void* data = module.has_component(command.entity, component)
+						? module.modify_component(command.entity, component)
+						: module.add_component(command.entity, component, command.element_size);
+					std::memcpy(data, arena + command.payload, command.element_size);
+					if(command.set_entity) command.set_entity(module, data, command.entity);
+				}
+			}
+		}
+	};
+}
@@ -4,9 +4,13 @@
 #define FP_IMPLEMENTATION
 #endif
 
+#include "allocator.hpp" // Must come before libfp so it can hook its allocations
+#include "profiling.hpp"
+
 #include <fp/hash/dictionary.hpp>
 #include <fp/hash/fnv1a.hpp>
 
+#include <cstring>
 #include <stdexcept>
 
 #include <typeinfo>
@@ -56,26 +60,27 @@ namespace ecrs {
 		size_t ecrs_component_id_from_name_view(const fp_string_view view, bool create_if_not_found = true) noexcept
 #ifdef ECRS_IMPLEMENTATION
 		{
-			bool free = false;
-			fp_string name = fp_string_view_make_dynamic(view); // TODO: Is there a way to skip the allocation here?
-			ForwardPair lookup{name, 0};
-			if(!fp_hash_map_contains(ForwardPair, ecrs_get_forward_map(), lookup)) {
-				if(create_if_not_found) {
-					size_t id = ecrs_get_next_component_id();
-					lookup.second = id;
-					fp_hash_map_insert(ForwardPair, ecrs_get_forward_map(), lookup);
-					ReversePair reverse{id, name};
-					fp_hash_map_insert(ReversePair, ecrs_get_reverse_map(), reverse);
-					return id;
-				} else {
-					fp_string_free(name);
-					return -1;
-				}
-			} else free = true;
-
-			auto out = fp_hash_map_find(ForwardPair, ecrs_get_forward_map(), lookup)->second;
-			if (free) fp_string_free(name);
-			return out;
+			ECRS_GLOBAL_ALLOCATION_SCOPE;
+			// Lookups go through a per thread scratch copy of the name, only names which get inserted need an allocation of their own
+			thread_local static fp::raii::dynarray<char> scratch{nullptr};
+			size_t size = fp_view_size(view);
+			fpda_reserve(scratch.raw, size + 1);
+			fpda_resize(scratch.raw, size);
+			std::memcpy(scratch.raw, fp_view_data(char, view), size);
+			scratch.raw[size] = '\0';
+
+			ForwardPair lookup{scratch.raw, 0};
+			if(auto found = fp_hash_map_find(ForwardPair, ecrs_get_forward_map(), lookup); found)
+				return found->second;
+			if(!create_if_not_found) return -1;
+
+			fp_string name = fp_string_view_make_dynamic(view);
+			size_t id = ecrs_get_next_component_id();
+			ForwardPair forward{name, id};
+			fp_hash_map_insert(ForwardPair, ecrs_get_forward_map(), forward);
+			ReversePair reverse{id, name};
+			fp_hash_map_insert(ReversePair, ecrs_get_reverse_map(), reverse);
+			return id;
 		}
 #else
 		;
@@ -142,6 +147,7 @@ namespace ecrs {
 		auto id = get_global_component_id_private<T, Unique>();
 #ifndef ecrs_DISABLE_STRING_COMPONENT_LOOKUP
 		static bool once = [id]{
+			ECRS_GLOBAL_ALLOCATION_SCOPE;
 			auto name = get_type_name<T>();
 			if constexpr(Unique > 0) {
 				fp_string num = fp_string_format("%u", Unique);
@@ -46,9 +46,23 @@ namespace ecrs {
 			Relation& operator=(const Relation&) = default;
 		};
 
+		// Bytes a relation storage's elements own outside of the storage (only dynamically sized relations have any)
+		template<std::derived_from<RelationBase> R>
+		size_t relation_payload_bytes(const Storage& storage) noexcept {
+			if constexpr(requires(R r) { r.related.capacity(); }) {
+				size_t out = 0;
+				for(size_t i = 0, size = storage.size(); i < size; ++i)
+					out += storage.get<R>(i).related.capacity() * sizeof(entity_or_term<R::can_be_term>);
+				return out;
+			} else return 0;
+		}
+
 		struct TrivialRelationalModule : public TrivialModule {
+			using relation_payload_function = size_t(*)(const Storage&);
+
 			std::unordered_map<component_t, entity_t> component_lookup;
 			kanren::State logic_state{this};
+			fp_dynarray(relation_payload_function) relation_payloads = nullptr; // Indexed by component id, set for every relation added through add_relation (used by stats)
 
 			Entity get_component_entity(component_t componentID) {
 				if(component_lookup.contains(componentID)) return component_lookup[componentID];
@@ -67,8 +81,29 @@ namespace ecrs {
 
 			template<std::derived_from<RelationBase> R, size_t Unique = 0>
 			inline auto& add_relation(entity_t e) {
+				component_t componentID = get_global_component_id<R, Unique>();
+				if(fpda_size(relation_payloads) <= componentID) {
+					ECRS_ALLOCATION_SCOPE(allocator);
+					fpda_grow_to_size_and_initialize(relation_payloads, componentID + 1, nullptr);
+				}
+				relation_payloads[componentID] = relation_payload_bytes<R>;
 				return add_component<R, Unique>(e).related;
 			}
+			// NOTE: Builds the related list inside the module's allocation scope, assigning to the reference returned above allocates from whatever is current
+			template<std::derived_from<RelationBase> R, size_t Unique = 0>
+			inline auto& add_relation(entity_t e, std::initializer_list<entity_or_term<R::can_be_term>> related) {
+				auto& out = add_relation<R, Unique>(e);
+				ECRS_ALLOCATION_SCOPE(allocator);
+				if constexpr(requires { out.capacity(); })
+					out = std::remove_cvref_t<decltype(out)>(related);
+				else {
+					assert(related.size() <= out.size());
+					auto init = related.begin();
+					for(size_t i = 0; i < related.size(); ++i, ++init)
+						out[i] = *init;
+				}
+				return out;
+			}
 
 			template<std::derived_from<RelationBase> R, size_t Unique = 0>
 			inline bool has_relation(entity_t e) const { return has_component<R, Unique>(e); }
@@ -83,6 +118,7 @@ namespace ecrs {
 
 			void free() {
 				TrivialModule::free();
+				if(relation_payloads) fpda_free_and_null(relation_payloads);
 				// TODO: Free component_lookup
 			}
 		};
@@ -91,6 +127,7 @@ namespace ecrs {
 			bool should_leak = false; // Useful when shutting down, if we are closing we can just leave memory cleanup to the operating system for a bit of added performance!
 
 			RelationalModule() = default;
+			RelationalModule(Allocator& allocator) { use_allocator(allocator); }
 			RelationalModule(const RelationalModule&) = delete; // Storages need to become copyable to change this...
 			RelationalModule(RelationalModule&& o) { *this = std::move(o); }
 			RelationalModule& operator=(const RelationalModule& o) = delete;
@@ -99,6 +136,13 @@ namespace ecrs {
 				entity_component_indices = std::exchange(o.entity_component_indices, nullptr);
 				storages = std::exchange(o.storages, nullptr);
 				freelist = std::exchange(o.freelist, nullptr);
+				entity_versions = std::exchange(o.entity_versions, nullptr);
+				groups = std::exchange(o.groups, nullptr);
+				tags = std::exchange(o.tags, nullptr);
+				change_tick = std::exchange(o.change_tick, 1);
+				scratch = std::exchange(o.scratch, {});
+				allocator = std::exchange(o.allocator, nullptr);
+				relation_payloads = std::exchange(o.relation_payloads, nullptr);
 				return *this;
 			}
 
@@ -109,9 +153,10 @@ namespace ecrs {
 
 		inline kanren::Goal auto stream_of_all_entities(const kanren::Variable& var, bool include_error = false) {
 			return [=](kanren::State state) -> std::generator<kanren::State> {
+				ECRS_COUNT(GoalSteps); // NOTE: Counted before the first co_yield, every goal run against a state is one step
 				auto [m, s, c] = state;
 				for(size_t e = include_error ? 0 : 1, size = fp_size(state.module->entity_component_indices); e < size; ++e)
-					if(!state.module->freelist || !fp_contains(state.module->freelist, e)) {
+					if(!state.module->is_released(e)) {
 						s.emplace_front(var, kanren::Term{e});
 						co_yield {m, s, c};
 						s.pop_front();
@@ -121,6 +166,7 @@ namespace ecrs {
 
 		inline kanren::Goal auto has_component(const kanren::Term& var, ecrs::component_t componentID) {
 			return [=](kanren::State state) -> std::generator<kanren::State> {
+				ECRS_COUNT(GoalSteps);
 				auto [m, s, c] = state;
 
 				auto var_ = kanren::find(var, s);
@@ -128,10 +174,19 @@ namespace ecrs {
 					if(m->has_component(std::get<ecrs::Entity>(var_), componentID))
 						co_yield state;
 
+				} else if(std::holds_alternative<kanren::Variable>(var_) && m->is_tag(componentID)) {
+					// Tags keep a bitset instead of indices, so generate every set bit
+					for(size_t w = 0, words = fp_size(m->tags[componentID]); w < words; ++w)
+						for(uint64_t bits = m->tags[componentID][w]; bits; bits &= bits - 1) {
+							s.emplace_front(std::get<kanren::Variable>(var_), kanren::Term{w * 64 + std::countr_zero(bits)});
+							co_yield {m, s, c};
+							s.pop_front();
+						}
+
 				} else if(std::holds_alternative<kanren::Variable>(var_))
 					for(size_t e = 0, size = fp_size(m->entity_component_indices); e < size; ++e) {
 						auto comps = m->entity_component_indices[e];
-						if(fp_size(comps) > componentID && comps[componentID] != ecrs::Storage::invalid) {
+						if(fp_size(comps) > componentID && comps[componentID] != ecrs::Storage::invalid_index) {
 							s.emplace_front(std::get<kanren::Variable>(var_), kanren::Term{e});
 							co_yield {m, s, c};
 							s.pop_front();
@@ -146,6 +201,7 @@ namespace ecrs {
 		inline kanren::Goal auto related_entities(const kanren::Term& base, const kanren::Term& relate) {
 			const auto componentID = get_global_component_id<T, Unique>();
 			return [=](kanren::State state) -> std::generator<kanren::State> {
+				ECRS_COUNT(GoalSteps);
 				auto [m, s, c] = state;
 				auto base_ = kanren::find(base, s);
 				auto relate_ = kanren::find(relate, s);
@@ -210,6 +266,7 @@ namespace ecrs {
 		inline kanren::Goal auto related_entities_list(const kanren::Term& base, const kanren::Term& relate) {
 			const auto componentID = get_global_component_id<T, Unique>();
 			return [=](kanren::State state) -> std::generator<kanren::State> {
+				ECRS_COUNT(GoalSteps);
 				auto [m, s, c] = state;
 				auto base_ = kanren::find(base, s);
 				auto relate_ = kanren::find(relate, s);
@@ -300,6 +357,15 @@ namespace ecrs {
 		// assert(dynamic_cast<TrivialRelationalModule*>(current_module) != nullptr);
 		return add_relation<R, Unique>(*(TrivialRelationalModule*)current_module);
 	}
+	template<typename R, size_t Unique /* = 0 */, typename Trelated>
+	inline auto& Entity::add_relation(TrivialRelationalModule& module, std::initializer_list<Trelated> related) {
+		return module.add_relation<R, Unique>(entity, related);
+	}
+	template<typename R, size_t Unique /* = 0 */, typename Trelated>
+	inline auto& Entity::add_relation(std::initializer_list<Trelated> related) {
+		assert(current_module != nullptr);
+		return add_relation<R, Unique>(*(TrivialRelationalModule*)current_module, related);
+	}
 	
 	template<typename R, size_t Unique /* = 0 */>
 	inline bool Entity::has_relation(const TrivialRelationalModule& module) const {
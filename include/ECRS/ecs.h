@@ -16,7 +16,13 @@
 	extern "C" {
 	#endif
 
+	#ifdef ECRS_COMPACT_INDICES
+	typedef uint32_t entity_t;
+	typedef uint32_t index_t;
+	#else
 	typedef size_t entity_t;
+	typedef size_t index_t;
+	#endif
 
 	size_t get_next_component_id();
 	size_t ecrs_component_id_from_name_view(const fp_string_view view, bool create_if_not_found /*= true*/);
@@ -25,10 +31,25 @@
 	void ecrs_component_id_free_maps();
 
 	struct Storage;
+	struct Group;
+	struct Allocator;
+	struct ScratchArena {
+		fp_dynarray(fp_dynarray(uint8_t)) blocks;
+		size_t block, used;
+		size_t capacity, merged;
+		struct Allocator* allocator;
+	};
 	struct Module {
-		fp_dynarray(fp_dynarray(size_t)) entity_component_indices;
+		fp_dynarray(fp_dynarray(index_t)) entity_component_indices;
 		fp_dynarray(Storage) storages;
 		fp_dynarray(entity_t) freelist;
+		fp_dynarray(uint32_t) entity_versions;
+		fp_dynarray(Group) groups;
+		fp_dynarray(fp_dynarray(uint64_t)) tags;
+		size_t structural_locks;
+		size_t change_tick;
+		ScratchArena scratch;
+		struct Allocator* allocator;
 		bool should_leak;
 	};
 #endif
@@ -2,19 +2,57 @@
 
 #include "component_id.hpp"
 
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstring>
 #include <numeric>
+#include <span>
 
 namespace ecrs {
 
+#ifdef ECRS_COMPACT_INDICES
+	// Entity ids and the indices stored in entity_component_indices are 32 bits (halving the memory bookkeeping takes)
+	//  Modules are limited to 2^32 - 1 entities and storages to 2^32 - 1 elements
+	using entity_t = uint32_t;
+	using index_t = uint32_t;
+#else
 	using entity_t = size_t;
+	using index_t = size_t;
+#endif
 	static constexpr size_t invalid_entity = 0;
 
 	using component_t = size_t;
 
-	template<typename T>
+	struct TrivialModule;
+
+	// An entity index packed alongside the version of the entity it refers to, handles to released entities can be detected with a single comparison
+	struct Handle {
+		uint64_t packed = 0;
+
+		constexpr Handle() = default;
+		// NOTE: Indices which don't fit in 32 bits produce invalid_handle
+		constexpr Handle(entity_t index, uint32_t version) : packed(uint64_t(index) >> 32 ? 0 : (uint64_t(version) << 32) | uint32_t(index)) {
+			assert((uint64_t(index) >> 32) == 0);
+		}
+
+		constexpr entity_t index() const { return packed & 0xFFFFFFFF; }
+		constexpr uint32_t version() const { return packed >> 32; }
+		// NOTE: Explicit so a handle can't be used as an entity without deciding whether it needs to be validated first
+		constexpr explicit operator entity_t() const { return index(); }
+
+		constexpr bool operator==(const Handle& other) const { return packed == other.packed; }
+		constexpr std::strong_ordering operator<=>(const Handle& other) const {
+			if(index() == other.index()) return version() <=> other.version();
+			return index() <=> other.index();
+		}
+	};
+	static constexpr Handle invalid_handle = {};
+
+	template<typename T, typename Tentity = entity_t>
 	struct with_entity {
 		T value;
-		entity_t entity = invalid_entity;
+		Tentity entity = {}; // Either invalid_entity or invalid_handle
 		operator T() { return value; }
 		operator const T() const { return value; }
 		T* operator->() { return &value; }
@@ -33,9 +71,17 @@ namespace ecrs {
 			return other.entity == entity && other.value == value;
 		}
 
-		static void swap_entities(with_entity& a, struct TrivialModule& module, entity_t eA, entity_t eB) {
-			if(a.entity == eA) a.entity = eB;
-			else if(a.entity == eB) a.entity = eA;
+		template<typename Tmodule>
+		void set_entity(Tmodule& module, entity_t e) {
+			if constexpr(std::is_same_v<Tentity, Handle>)
+				entity = module.handle(e);
+			else entity = e;
+		}
+
+		template<typename Tmodule>
+		static void swap_entities(with_entity& a, Tmodule& module, entity_t eA, entity_t eB) {
+			if(entity_t(a.entity) == eA) a.set_entity(module, eB);
+			else if(entity_t(a.entity) == eB) a.set_entity(module, eA);
 		}
 	};
 
@@ -59,15 +105,15 @@ namespace ecrs {
 
 		template<typename T>
 		struct is_with_entity : public std::false_type {};
-		template<typename T>
-		struct is_with_entity<with_entity<T>> : public std::true_type {};
+		template<typename T, typename Tentity>
+		struct is_with_entity<with_entity<T, Tentity>> : public std::true_type {};
 		template<typename T>
 		constexpr static bool is_with_entity_v = is_with_entity<T>::value;
 
 		template<typename T>
 		struct remove_with_entity { using type = T; };
-		template<typename T>
-		struct remove_with_entity<with_entity<T>> { using type = typename remove_with_entity<T>::type; };
+		template<typename T, typename Tentity>
+		struct remove_with_entity<with_entity<T, Tentity>> { using type = typename remove_with_entity<T>::type; };
 		template<typename T>
 		using remove_with_entity_t = typename remove_with_entity<T>::type;
 
@@ -81,20 +127,108 @@ namespace ecrs {
 		using nth_type = typename std::tuple_element<N, std::tuple<Ts...>>::type;
 
 		struct void_like{};
+
+		// Keys which can be radix sorted (long double's representation varies too much between platforms)
+		template<typename T>
+		concept radix_sortable = std::is_arithmetic_v<T> && (!std::is_floating_point_v<T> || sizeof(T) == 4 || sizeof(T) == 8);
+
+		// Maps a key to an unsigned integer which sorts in the same order
+		template<radix_sortable T>
+		inline auto radix_key(T value) noexcept {
+			if constexpr(std::is_same_v<T, bool>) return uint8_t(value);
+			else if constexpr(std::is_floating_point_v<T>) {
+				using U = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+				constexpr U sign = U(1) << (sizeof(U) * 8 - 1);
+				U bits = std::bit_cast<U>(value);
+				return U(bits & sign ? ~bits : bits | sign); // Negatives sort backwards, and before every positive
+			} else if constexpr(std::is_signed_v<T>) {
+				using U = std::make_unsigned_t<T>;
+				return U(U(value) ^ (U(1) << (sizeof(U) * 8 - 1)));
+			} else return value;
+		}
+
+		// Stable LSD radix sort (8 bits per pass) of keys, order receives the same permutation
+		//  The scratch buffers must hold size elements, passes where every key shares a digit are skipped
+		template<std::unsigned_integral K>
+		void radix_sort(K* keys, size_t* order, K* key_scratch, size_t* order_scratch, size_t size) noexcept {
+			constexpr size_t passes = sizeof(K);
+			size_t counts[passes][256] = {};
+			for(size_t i = 0; i < size; ++i)
+				for(size_t pass = 0; pass < passes; ++pass)
+					++counts[pass][(keys[i] >> (pass * 8)) & 0xFF];
+
+			K* keys_from = keys, *keys_to = key_scratch;
+			size_t* order_from = order, *order_to = order_scratch;
+			for(size_t pass = 0; pass < passes; ++pass) {
+				auto& offsets = counts[pass];
+				size_t shift = pass * 8;
+				if(offsets[(keys_from[0] >> shift) & 0xFF] == size) continue;
+				for(size_t digit = 0, sum = 0; digit < 256; ++digit)
+					sum += std::exchange(offsets[digit], sum);
+				for(size_t i = 0; i < size; ++i) {
+					size_t to = offsets[(keys_from[i] >> shift) & 0xFF]++;
+					keys_to[to] = keys_from[i];
+					order_to[to] = order_from[i];
+				}
+				std::swap(keys_from, keys_to);
+				std::swap(order_from, order_to);
+			}
+			if(order_from != order) {
+				std::memcpy(keys, keys_from, size * sizeof(K));
+				std::memcpy(order, order_from, size * sizeof(size_t));
+			}
+		}
 	}
 
+	// Alignment (in bytes) the storage for T guarantees its first element has, specialize (or add a static constexpr size_t storage_alignment member to T) to align component arrays for SIMD
+	template<typename T>
+	struct storage_alignment : public std::integral_constant<size_t, alignof(T)> {};
+	template<typename T>
+	requires(requires { {T::storage_alignment} -> std::convertible_to<size_t>; })
+	struct storage_alignment<T> : public std::integral_constant<size_t, T::storage_alignment> {};
+	template<typename T>
+	constexpr static size_t storage_alignment_v = storage_alignment<T>::value;
+
+	// A storage's elements, data is aligned to alignment bytes and elements [size, padded_size) exist (with unspecified values) so vectorized loops can run past the end without a remainder loop
+	template<typename T>
+	struct aligned_span {
+		T* data;
+		size_t size, padded_size, alignment;
+
+		inline T* begin() const noexcept { return data; }
+		inline T* end() const noexcept { return data + size; }
+		inline T& operator[](size_t i) const noexcept { return data[i]; }
+		inline operator std::span<T>() const noexcept { return {data, size}; }
+		inline std::span<T> padded() const noexcept { return {data, padded_size}; }
+	};
+
 	struct Storage {
 		static constexpr size_t invalid = std::numeric_limits<size_t>::max();
+		static constexpr index_t invalid_index = std::numeric_limits<index_t>::max(); // Marks components an entity doesn't have in entity_component_indices
+		static constexpr size_t default_chunk_bytes = 16 * 1024;
+		static constexpr size_t natural_alignment = alignof(std::max_align_t); // Alignments up to this are provided by the allocator
 		size_t element_size = invalid;
-		fp_dynarray(uint8_t) raw = nullptr;
+		fp_dynarray(uint8_t) raw = nullptr; // Unused when chunked
+		size_t alignment = 0; // Guaranteed alignment of the first element (zero if no more than natural_alignment is needed)
+		size_t offset = 0; // Byte offset of the first element in raw (only non-zero when aligned)
+		fp_dynarray(entity_t) entities = nullptr; // Maps each slot back to the entity which owns it (invalid_entity if the slot is unowned)
+		fp_dynarray(size_t) added_ticks = nullptr; // Module tick each slot's component was added during (only when tracked)
+		fp_dynarray(size_t) changed_ticks = nullptr; // Module tick each slot's component was last marked changed during (only when tracked)
+		fp_dynarray(fp_dynarray(uint8_t)) chunks = nullptr; // Fixed size blocks of chunk_size elements (only when chunked)
+		size_t chunk_size = 0; // Elements per chunk, zero if the storage is a single contiguous array
+		size_t group = invalid; // Index of the group which owns this storage (invalid if not grouped)
+		Allocator* allocator = nullptr; // Where the storage's arrays come from (the thread's current allocator if null)
 		bool should_leak = false; // Useful when shutting down, if we are closing we can just leave memory cleanup to the operating system for a bit of added performance!
 
 
-		inline Storage() noexcept : element_size(invalid), raw(nullptr) {}
-		inline Storage(size_t element_size, size_t reserved_element_count = 64) noexcept : element_size(element_size), raw(nullptr) { fpda_reserve(raw, reserved_element_count * element_size); }
+		inline Storage() noexcept : element_size(invalid), raw(nullptr), entities(nullptr) {}
+		inline Storage(size_t element_size, size_t reserved_element_count = 64, size_t alignment = 0, Allocator* allocator = nullptr) noexcept : element_size(element_size), raw(nullptr), entities(nullptr), allocator(allocator) {
+			if(alignment > natural_alignment) this->alignment = alignment;
+			reserve(reserved_element_count);
+		}
 
 		template<typename Tcomponent>
-		inline Storage(Tcomponent reference = {}, size_t reserved_element_count = 64) noexcept : Storage(sizeof(Tcomponent), reserved_element_count) {}
+		inline Storage(Tcomponent reference = {}, size_t reserved_element_count = 64) noexcept : Storage(sizeof(Tcomponent), reserved_element_count, storage_alignment_v<Tcomponent>) {}
 		Storage(const Storage& o) = delete;
 		inline Storage(Storage&& o) { *this = std::move(o); }
 
@@ -103,55 +237,251 @@ namespace ecrs {
 			element_size = o.element_size;
 			if(raw) fpda_free_and_null(raw);
 			raw = std::exchange(o.raw, nullptr);
+			alignment = std::exchange(o.alignment, 0);
+			offset = std::exchange(o.offset, 0);
+			if(entities) fpda_free_and_null(entities);
+			entities = std::exchange(o.entities, nullptr);
+			free_ticks();
+			added_ticks = std::exchange(o.added_ticks, nullptr);
+			changed_ticks = std::exchange(o.changed_ticks, nullptr);
+			free_chunks();
+			chunks = std::exchange(o.chunks, nullptr);
+			chunk_size = std::exchange(o.chunk_size, 0);
+			group = std::exchange(o.group, invalid);
+			allocator = std::exchange(o.allocator, nullptr);
 			should_leak = o.should_leak;
 			return *this;
 		}
 
-		inline ~Storage() noexcept { if(!should_leak && raw) fpda_free_and_null(raw); }
+		inline ~Storage() noexcept {
+			if(should_leak) return;
+			if(raw) fpda_free_and_null(raw);
+			if(entities) fpda_free_and_null(entities);
+			free_ticks();
+			free_chunks();
+		}
+
+		// Switches the storage to fixed size chunks, references to elements then stay valid as the storage grows
+		//  NOTE: data() and view() are only available for contiguous storages, chunked storages should be iterated chunk by chunk
+		void make_chunked(size_t chunk_bytes = default_chunk_bytes) noexcept {
+			assert(element_size != invalid);
+			assert(group == invalid); // Groups rely on contiguous storages
+			assert(alignment == 0); // Chunks don't support extra alignment
+			if(chunked()) return;
+			ECRS_ALLOCATION_SCOPE(allocator);
+			size_t size = this->size();
+			chunk_size = std::max<size_t>(chunk_bytes / element_size, 1);
+			grow_chunks(size);
+			for(size_t i = 0, chunk = 0; i < size; i += chunk_size, ++chunk)
+				std::memcpy(chunks[chunk], raw + offset + i * element_size, std::min(chunk_size, size - i) * element_size);
+			if(raw) fpda_free_and_null(raw);
+		}
+		inline bool chunked() const noexcept { return chunk_size != 0; }
+
+		// Number of blocks of contiguous memory the storage is split into (one if the storage isn't chunked)
+		inline size_t chunk_count() const noexcept {
+			if(!chunked()) return empty() ? 0 : 1;
+			return (size() + chunk_size - 1) / chunk_size;
+		}
+		// The contiguous elements in block i
+		template<typename T>
+		inline std::span<T> chunk(size_t i) noexcept {
+			assert(sizeof(T) == element_size);
+			assert(i < chunk_count());
+			if(!chunked()) return {data<T>(), size()};
+			return {(T*)chunks[i], std::min(chunk_size, size() - i * chunk_size)};
+		}
+
+		// Changes the guaranteed alignment of the first element (moving any existing elements)
+		void align_to(size_t alignment) noexcept {
+			assert(!chunked());
+			if(alignment <= natural_alignment) alignment = 0;
+			if(alignment == this->alignment) return;
+			ECRS_ALLOCATION_SCOPE(allocator);
+			size_t size = this->size();
+			fp_dynarray(uint8_t) old = std::exchange(raw, nullptr);
+			size_t oldOffset = std::exchange(offset, 0);
+			this->alignment = alignment;
+			fpda_grow(raw, slack() + size * element_size);
+			offset = aligned_offset();
+			if(old) {
+				std::memcpy(raw + offset, old + oldOffset, size * element_size);
+				fpda_free_and_null(old);
+			}
+		}
 
 		template<typename T>
 		inline T* data() noexcept {
 			assert(sizeof(T) == element_size); // Implies element_size != invalid (since no type should ever be that big!)
-			return (T*)raw;
+			assert(!chunked());
+			return (T*)(raw + offset);
 		}
 		template<typename T>
 		inline const T* data() const noexcept {
 			assert(sizeof(T) == element_size); // Implies element_size != invalid (since no type should ever be that big!)
-			return (const T*)raw;
+			assert(!chunked());
+			return (const T*)(raw + offset);
 		}
 
-		inline size_t size() const noexcept { return fpda_size(raw) / element_size; }
+		// The elements as an aligned span (padded to a whole multiple of the alignment)
+		template<typename T>
+		inline aligned_span<T> aligned() noexcept {
+			size_t size = this->size();
+			if(!alignment) return {data<T>(), size, size, alignof(T)};
+			size_t padded_bytes = (size * element_size + alignment - 1) / alignment * alignment; // NOTE: slack() leaves room for this much
+			return {data<T>(), size, padded_bytes / element_size, alignment};
+		}
+
+		inline size_t size() const noexcept {
+			if(chunked()) return fpda_size(entities);
+			size_t bytes = fpda_size(raw);
+			return bytes > slack() ? (bytes - slack()) / element_size : 0;
+		}
 		inline bool empty() const noexcept { return size() == 0; }
 
 		inline void* get(entity_t e) noexcept {
 			assert(e < size());
-			return raw + e * element_size;
+			if(chunked()) return chunks[e / chunk_size] + (e % chunk_size) * element_size;
+			return raw + offset + e * element_size;
 		}
 		inline const void* get(entity_t e) const noexcept {
 			assert(e < size());
-			return raw + e * element_size;
+			if(chunked()) return chunks[e / chunk_size] + (e % chunk_size) * element_size;
+			return raw + offset + e * element_size;
 		}
 		template<typename T>
 		inline T& get(entity_t e) noexcept {
-			assert(e < size());
-			return *(data<T>() + e);
+			assert(sizeof(T) == element_size);
+			return *(T*)get(e);
 		}
 		template<typename T>
 		inline const T& get(entity_t e) const noexcept {
-			assert(e < size());
-			return *(data<T>() + e);
+			assert(sizeof(T) == element_size);
+			return *(const T*)get(e);
 		}
 
 		template<typename T>
 		void allocate(size_t count = 1) noexcept {
+			if constexpr(std::is_trivially_default_constructible_v<T>) {
+				allocate(count); // Value initializing a trivial type zeros it
+				return;
+			}
+			ECRS_ALLOCATION_SCOPE(allocator);
 			auto originalEnd = size();
-			fpda_grow(raw, element_size * count);
+			if(chunked()) {
+				grow_chunks(originalEnd + count);
+				grow_entities(count);
+				for (size_t i = 0; i < count; i++)
+					new(&get<T>(originalEnd + i)) T();
+				return;
+			}
+			grow_uninitialized(count);
 			auto data = this->data<T>();
 			for (size_t i = 0; i < count; i++)
 				new(data + originalEnd + i) T();
 		}
 		inline void allocate(size_t count = 1) noexcept {
+			ECRS_ALLOCATION_SCOPE(allocator);
+			if(chunked()) {
+				size_t originalEnd = size();
+				grow_chunks(originalEnd + count);
+				grow_entities(count);
+				for (size_t i = 0; i < count; i++)
+					std::memset(get(originalEnd + i), 0, element_size);
+				return;
+			}
+			if(alignment) {
+				size_t originalEnd = size();
+				grow_uninitialized(count);
+				std::memset(raw + offset + originalEnd * element_size, 0, count * element_size);
+				return;
+			}
 			fpda_grow_and_initialize(raw, element_size * count, 0);
+			grow_entities(count);
+		}
+
+		// Adds count elements without initializing them (unowned by any entity)
+		void grow_uninitialized(size_t count) noexcept {
+			ECRS_ALLOCATION_SCOPE(allocator);
+			if(chunked()) {
+				grow_chunks(size() + count);
+				grow_entities(count);
+				return;
+			}
+			size_t size = this->size();
+			if(fpda_size(raw) < slack()) fpda_grow_to_size(raw, slack());
+			fpda_grow(raw, element_size * count);
+			realign(size);
+			grow_entities(count);
+		}
+		// Makes sure count elements fit without reallocating
+		void reserve(size_t count) noexcept {
+			ECRS_ALLOCATION_SCOPE(allocator);
+			if(!chunked()) {
+				fpda_reserve(raw, slack() + count * element_size);
+				realign(size());
+			}
+			fpda_reserve(entities, count);
+			if(tracked()) {
+				fpda_reserve(added_ticks, count);
+				fpda_reserve(changed_ticks, count);
+			}
+		}
+
+		// Starts recording the tick each slot was added/changed during (existing elements are treated as added and changed during tick)
+		void make_tracked(size_t tick = 0) noexcept {
+			if(tracked()) return;
+			ECRS_ALLOCATION_SCOPE(allocator);
+			size_t size = fpda_size(entities);
+			fpda_reserve(added_ticks, size + 1); // NOTE: Reserving makes sure an empty storage still counts as tracked
+			fpda_reserve(changed_ticks, size + 1);
+			if(size == 0) return;
+			fpda_grow_to_size_and_initialize(added_ticks, size, tick);
+			fpda_grow_to_size_and_initialize(changed_ticks, size, tick);
+		}
+		inline bool tracked() const noexcept { return added_ticks != nullptr; }
+
+		inline void mark_added(size_t index, size_t tick) noexcept {
+			if(!tracked()) return;
+			assert(index < size());
+			added_ticks[index] = changed_ticks[index] = tick;
+		}
+		inline void mark_changed(size_t index, size_t tick) noexcept {
+			if(!tracked()) return;
+			assert(index < size());
+			changed_ticks[index] = tick;
+		}
+		// NOTE: "Since" is exclusive, an element marked during tick since doesn't count
+		inline bool added_since(size_t index, size_t since) const noexcept {
+			assert(tracked());
+			return added_ticks[index] > since;
+		}
+		inline bool changed_since(size_t index, size_t since) const noexcept {
+			assert(tracked());
+			return changed_ticks[index] > since;
+		}
+
+		// Gets the entity which owns the element in slot index (invalid_entity if the slot is unowned)
+		inline entity_t get_entity(size_t index) const noexcept {
+			if(index >= fpda_size(entities)) return invalid_entity;
+			return entities[index];
+		}
+
+		// Removes every element past the first count (without running their destructors)
+		inline void truncate(size_t count) noexcept {
+			size_t size = this->size();
+			if(count >= size) return;
+			if(!chunked()) fpda_delete_range(raw, fpda_size(raw) - (size - count) * element_size, (size - count) * element_size);
+			fpda_delete_range(entities, count, size - count); // NOTE: Chunks are kept around for reuse
+			if(tracked()) {
+				fpda_delete_range(added_ticks, count, size - count);
+				fpda_delete_range(changed_ticks, count, size - count);
+			}
+		}
+		// Removes the last element (without running its destructor)
+		inline void pop_back() noexcept {
+			assert(size() > 0);
+			truncate(size() - 1);
 		}
 
 		template<typename T>
@@ -174,18 +504,18 @@ namespace ecrs {
 			assert(a < size());
 			assert(b < size());
 
-			Tcomponent* aPtr = data<Tcomponent>() + a;
-			Tcomponent* bPtr = data<Tcomponent>() + b;
-			std::swap(*aPtr, *bPtr);
+			std::swap(get<Tcomponent>(a), get<Tcomponent>(b));
+			std::swap(entities[a], entities[b]);
+			swap_ticks(a, b);
 		}
 		void swap(size_t a, std::optional<size_t> _b = {}) {
 			size_t b = _b.value_or(size() - 1);
 			assert(a < size());
 			assert(b < size());
 
-			void* aPtr = raw + a * element_size;
-			void* bPtr = raw + b * element_size;
-			memswap(aPtr, bPtr, element_size);
+			memswap(get(a), get(b), element_size);
+			std::swap(entities[a], entities[b]);
+			swap_ticks(a, b);
 		}
 
 		template<typename Tcomponent, size_t Unique = 0>
@@ -205,33 +535,201 @@ namespace ecrs {
 		template<typename F, bool with_entities = false>
 		void sort(struct TrivialModule& module, size_t component_id, const F& comparator);
 
+		// Sorts by key(const Tcomponent&), arithmetic keys are radix sorted (stably) anything else falls back to a comparison sort
+		template<typename Tcomponent, typename F, size_t Unique = 0>
+		void sort_by_key(struct TrivialModule& module, const F& key);
+
 		template<typename Tcomponent, size_t Unique = 0>
 		void sort_by_value(struct TrivialModule& module) {
-			constexpr static auto comparator = [](Tcomponent* a, Tcomponent* b) {
-				return std::less<Tcomponent>{}(*a, *b);
-			};
-			sort<Tcomponent, decltype(comparator), false, Unique>(module, comparator);
+			if constexpr(detail::radix_sortable<Tcomponent>) {
+				constexpr static auto identity = [](const Tcomponent& value) { return value; };
+				sort_by_key<Tcomponent, decltype(identity), Unique>(module, identity);
+			} else {
+				constexpr static auto comparator = [](Tcomponent* a, Tcomponent* b) {
+					return std::less<Tcomponent>{}(*a, *b);
+				};
+				sort<Tcomponent, decltype(comparator), false, Unique>(module, comparator);
+			}
 		}
 
+		// NOTE: Entities are integers so these are always radix sorted
 		template<typename Tcomponent, size_t Unique = 0>
-		void sort_monotonic(struct TrivialModule& module) {
-			auto comparator = [](Tcomponent* a, entity_t eA, Tcomponent* b, entity_t eB) {
-				return std::less<entity_t>{}(eA, eB);
-			};
-			sort<Tcomponent, decltype(comparator), true, Unique>(module, comparator);
+		void sort_monotonic(struct TrivialModule& module);
+		void sort_monotonic(struct TrivialModule& module, size_t component_id);
+
+		// Moves the element in slot order[i] into slot i (for every i) in a single pass, keeping the module's book keeping in step
+		//  NOTE: Components which aren't trivially copyable are moved through their constructors, which requires knowing their type
+		template<typename Tcomponent = detail::void_like>
+		void permute(struct TrivialModule& module, size_t component_id, const size_t* order);
+
+		// Moves slot read's element (and book keeping) into slot write, leaving read's contents moved from
+		template<typename Tcomponent = detail::void_like>
+		inline void move_slot(size_t write, size_t read) noexcept {
+			if constexpr(std::is_same_v<Tcomponent, detail::void_like> || std::is_trivially_copyable_v<Tcomponent>)
+				std::memcpy(get(write), get(read), element_size); // NOTE: Untyped storages relocate bytes, just like growing them does
+			else get<Tcomponent>(write) = std::move(get<Tcomponent>(read));
+			entities[write] = entities[read];
+			if(tracked()) {
+				added_ticks[write] = added_ticks[read];
+				changed_ticks[write] = changed_ticks[read];
+			}
 		}
-		void sort_monotonic(struct TrivialModule& module, size_t component_id) {
-			auto comparator = [](void* a, entity_t eA, void* b, entity_t eB) {
-				return std::less<entity_t>{}(eA, eB);
-			};
-			sort<decltype(comparator), true>(module, component_id, comparator);
+
+	protected:
+		inline void grow_entities(size_t count) noexcept {
+			fpda_grow_and_initialize(entities, count, invalid_entity);
+			if(tracked()) {
+				fpda_grow_and_initialize(added_ticks, count, 0);
+				fpda_grow_and_initialize(changed_ticks, count, 0);
+			}
+		}
+		inline void swap_ticks(size_t a, size_t b) noexcept {
+			if(!tracked()) return;
+			std::swap(added_ticks[a], added_ticks[b]);
+			std::swap(changed_ticks[a], changed_ticks[b]);
+		}
+		inline void free_ticks() noexcept {
+			if(added_ticks) fpda_free_and_null(added_ticks);
+			if(changed_ticks) fpda_free_and_null(changed_ticks);
+		}
+
+		// Extra bytes raw holds when aligned: up to alignment - 1 in front of the first element, and enough behind the last to pad to a multiple of the alignment
+		inline size_t slack() const noexcept { return alignment ? 2 * alignment : 0; }
+		inline size_t aligned_offset() const noexcept {
+			if(!alignment || !raw) return 0;
+			return (alignment - (uintptr_t)raw % alignment) % alignment;
+		}
+		// Moves the first count elements back into alignment after raw has been reallocated (reallocation keeps bytes at the same offset from raw)
+		inline void realign(size_t count) noexcept {
+			size_t desired = aligned_offset();
+			if(desired == offset) return;
+			std::memmove(raw + desired, raw + offset, count * element_size);
+			offset = desired;
+		}
+
+		// Makes sure there are enough chunks for count elements
+		void grow_chunks(size_t count) noexcept {
+			for(size_t needed = (count + chunk_size - 1) / chunk_size; fpda_size(chunks) < needed; ) {
+				fp_dynarray(uint8_t) chunk = nullptr;
+				fpda_grow_to_size(chunk, chunk_size * element_size); // NOTE: Never resized so pointers into it stay valid
+				fpda_push_back(chunks, chunk);
+			}
+		}
+		inline void free_chunks() noexcept {
+			if(!chunks) return;
+			fpda_iterate(chunks)
+				if(*i) fpda_free_and_null(*i);
+			fpda_free_and_null(chunks);
+		}
+	};
+
+	// A set of components whose storages are kept ordered so that the entities with all of them occupy the leading [0, size) slots of every storage
+	struct Group {
+		fp_dynarray(component_t) components = nullptr;
+		size_t size = 0;
+	};
+
+	// Reusable temporary memory (for sorts, reorders, etc...) handed out like a stack and kept between uses
+	//  Blocks never move once allocated, so earlier allocations stay valid while later ones are made
+	struct ScratchArena {
+		constexpr static size_t alignment = alignof(std::max_align_t);
+		constexpr static size_t stack_threshold = 16 * 1024; // Requests up to this many bytes are made on the caller's stack instead (see ECRS_SCRATCH)
+
+		fp_dynarray(fp_dynarray(uint8_t)) blocks = nullptr;
+		size_t block = 0, used = 0; // Block allocations currently come from, and how many of its bytes are taken
+		size_t capacity = 0, merged = 0; // Bytes across every block, and how many there were when the blocks were last merged
+		Allocator* allocator = nullptr; // Where blocks come from (the thread's current allocator if null)
+
+		// Everything allocated while a scope is alive is handed back when it ends
+		struct Scope {
+			ScratchArena& arena;
+			size_t block, used;
+			Scope(ScratchArena& arena) noexcept : arena(arena), block(arena.block), used(arena.used) {}
+			~Scope() noexcept { arena.rewind(block, used); }
+		};
+
+		// Makes the arena the one this thread's storage sorts take memory from while alive (so several threads can sort storages of one module at once)
+		struct Override {
+			ScratchArena* previous;
+			Override(ScratchArena& arena) noexcept : previous(std::exchange(current, &arena)) {}
+			~Override() noexcept { current = previous; }
+		};
+		static inline thread_local ScratchArena* current = nullptr;
+
+		template<typename T>
+		T* allocate(size_t count) noexcept {
+			size_t bytes = (count * sizeof(T) + alignment - 1) / alignment * alignment;
+			for(size_t size = fpda_size(blocks); block < size; ++block, used = 0)
+				if(used + bytes <= fpda_size(blocks[block])) {
+					T* out = (T*)(blocks[block] + used);
+					used += bytes;
+					return out;
+				}
+
+			// Nothing left fits, add a block at least as big as every other block combined
+			ECRS_ALLOCATION_SCOPE(allocator);
+			fp_dynarray(uint8_t) fresh = nullptr;
+			fpda_grow_to_size(fresh, std::max(bytes, capacity));
+			fpda_push_back(blocks, fresh);
+			capacity += fpda_size(fresh);
+			block = fpda_size(blocks) - 1;
+			used = bytes;
+			return (T*)fresh;
+		}
+
+		inline void rewind(size_t block, size_t used) noexcept {
+			this->block = block;
+			this->used = used;
+			if(block != 0 || used != 0 || capacity == merged) return;
+			merged = capacity;
+			if(fpda_size(blocks) <= 1) return;
+
+			// Nothing is in use and blocks were added since the last merge, merge them so next time everything fits in one
+			ECRS_ALLOCATION_SCOPE(allocator);
+			fpda_iterate(blocks)
+				fpda_free_and_null(*i);
+			fpda_clear(blocks);
+			fp_dynarray(uint8_t) combined = nullptr;
+			fpda_grow_to_size(combined, capacity);
+			fpda_push_back(blocks, combined);
+		}
+
+		inline void free() noexcept {
+			if(!blocks) return;
+			fpda_iterate(blocks)
+				if(*i) fpda_free_and_null(*i);
+			fpda_free_and_null(blocks);
+			block = used = capacity = merged = 0;
 		}
 	};
 
+	// count Ts of scratch memory which live until the end of the enclosing ScratchArena::Scope (or function when small enough to come from the stack)
+	#define ECRS_SCRATCH(arena, type, count) ((count) * sizeof(type) <= ecrs::ScratchArena::stack_threshold\
+		? (type*)fp_alloca(type, (count)) : (arena).template allocate<type>(count))
+
 	struct TrivialModule {
-		fp_dynarray(fp_dynarray(size_t)) entity_component_indices = nullptr;
+		fp_dynarray(fp_dynarray(index_t)) entity_component_indices = nullptr;
 		fp_dynarray(Storage) storages = nullptr;
 		fp_dynarray(entity_t) freelist = nullptr;
+		fp_dynarray(uint32_t) entity_versions = nullptr; // Bumped every time an entity is released
+		fp_dynarray(Group) groups = nullptr;
+		fp_dynarray(fp_dynarray(uint64_t)) tags = nullptr; // Indexed by component id, a bitset over entity ids for each tag (null for anything which isn't a tag)
+		std::atomic<size_t> structural_locks = 0; // While non-zero (ie during parallel iteration) entities and components may not be created, destroyed, or moved
+		size_t change_tick = 1; // Stamped onto components added/changed in tracked storages, see advance_tick
+		ScratchArena scratch; // Temporary memory for sorting and reordering large storages
+		Allocator* allocator = nullptr; // Where every array the module (and its storages) grows comes from (the thread's current allocator if null)
+
+		// Routes all future growth of the module, its storages, and its scratch arena through allocator
+		//  NOTE: Arrays which already exist keep growing (and are freed) through the allocator they came from
+		void use_allocator(Allocator& allocator) noexcept {
+			this->allocator = &allocator;
+			scratch.allocator = &allocator;
+			fpda_iterate(storages)
+				i->allocator = &allocator;
+		}
+
+		// Arena storage sorts on this thread take their temporary memory from (the module's unless a ScratchArena::Override is alive)
+		inline ScratchArena& scratch_arena() noexcept { return ScratchArena::current ? *ScratchArena::current : scratch; }
 
 		inline void free() {
 			if(entity_component_indices) {
@@ -245,11 +743,62 @@ namespace ecrs {
 				fpda_free_and_null(storages);
 			}
 			if(freelist) fpda_free_and_null(freelist);
+			if(entity_versions) fpda_free_and_null(entity_versions);
+			if(groups) {
+				fpda_iterate(groups)
+					if(i->components) fpda_free_and_null(i->components);
+				fpda_free_and_null(groups);
+			}
+			if(tags) {
+				fpda_iterate(tags)
+					if(*i) fpda_free_and_null(*i);
+				fpda_free_and_null(tags);
+			}
+			scratch.free();
 		}
 
 		size_t entity_count() const { return fpda_size(entity_component_indices); }
 
-		Storage& get_storage(component_t componentID, size_t element_size = Storage::invalid) noexcept {
+		// Tags don't take up space in entity_component_indices, instead each tag keeps a bitset with one bit per entity
+		inline bool is_tag(component_t componentID) const noexcept { return fpda_size(tags) > componentID && tags[componentID]; }
+		inline bool has_tag(entity_t e, component_t componentID) const noexcept {
+			if(fpda_size(tags) <= componentID) return false;
+			auto bits = tags[componentID];
+			return fpda_size(bits) > e / 64 && (bits[e / 64] >> (e % 64)) & 1;
+		}
+		// Bits [64 * word, 64 * word + 64) of the tag's bitset
+		inline uint64_t tag_word(component_t componentID, size_t word) const noexcept {
+			if(fpda_size(tags) <= componentID || fpda_size(tags[componentID]) <= word) return 0;
+			return tags[componentID][word];
+		}
+		// Number of entities with the tag
+		size_t tag_count(component_t componentID) const noexcept {
+			size_t out = 0;
+			for(size_t w = 0, size = fpda_size(tags) > componentID ? fpda_size(tags[componentID]) : 0; w < size; ++w)
+				out += std::popcount(tags[componentID][w]);
+			return out;
+		}
+		void register_tag(component_t componentID) noexcept {
+			ECRS_ALLOCATION_SCOPE(allocator);
+			if(fpda_size(tags) <= componentID)
+				fpda_grow_to_size_and_initialize(tags, componentID + 1, nullptr);
+			if(!tags[componentID]) fpda_reserve(tags[componentID], 1); // NOTE: A non-null bitset is what marks the component as a tag
+		}
+		void set_tag(entity_t e, component_t componentID, bool value = true) noexcept {
+			assert(!structurally_locked());
+			register_tag(componentID);
+			auto& bits = tags[componentID];
+			if(fpda_size(bits) <= e / 64) {
+				if(!value) return;
+				ECRS_ALLOCATION_SCOPE(allocator);
+				fpda_grow_to_size_and_initialize(bits, e / 64 + 1, 0);
+			}
+			if(value) bits[e / 64] |= uint64_t(1) << (e % 64);
+			else bits[e / 64] &= ~(uint64_t(1) << (e % 64));
+		}
+
+		Storage& get_storage(component_t componentID, size_t element_size = Storage::invalid, size_t alignment = 0) noexcept {
+			ECRS_ALLOCATION_SCOPE(allocator);
 			if(!storages || fpda_size(storages) <= componentID) {
 				size_t old = fpda_size(storages);
 				fpda_grow_to_size(storages, componentID + 1);
@@ -258,7 +807,7 @@ namespace ecrs {
 			}
 			if(storages[componentID].element_size == Storage::invalid) {
 				assert(element_size != Storage::invalid);
-				storages[componentID] = Storage(element_size);
+				storages[componentID] = Storage(element_size, 64, alignment, allocator);
 			}
 			return storages[componentID];
 		}
@@ -269,79 +818,199 @@ namespace ecrs {
 		}
 
 		template<typename T, size_t Unique = 0>
-		inline Storage& get_storage() noexcept { return get_storage(get_global_component_id<T, Unique>(), sizeof(T)); }
+		inline Storage& get_storage() noexcept { return get_storage(get_global_component_id<T, Unique>(), sizeof(T), storage_alignment_v<T>); }
 		template<typename T, size_t Unique = 0>
 		inline const Storage& get_storage() const noexcept { return get_storage(get_global_component_id<T, Unique>(), sizeof(T)); }
 
 		bool release_storage(component_t componentID, bool update_entities = true) noexcept {
 			if(fpda_size(storages) <= componentID) return false;
 			if(storages[componentID].element_size == Storage::invalid) return false;
+			assert(storages[componentID].group == Storage::invalid); // Grouped storages can't be released
 			storages[componentID] = Storage();
 
 			if(update_entities) fp_iterate_named(entity_component_indices, e)
 				if(fpda_size(*e) > componentID)
-					(*e)[componentID] = Storage::invalid;
+					(*e)[componentID] = Storage::invalid_index;
 			return true;
 		}
 		template<typename T, size_t Unique = 0>
 		inline bool release_storage(bool update_entities = true) noexcept { return release_storage(get_global_component_id<T, Unique>(), update_entities); }
 
+		inline bool structurally_locked() const noexcept { return structural_locks > 0; }
+
+		// Creates count new entities with contiguous ids, returns the first (the entities are [first, first + count))
+		//  NOTE: Never reuses released entities (they aren't contiguous)
+		entity_t create_entities(size_t count) noexcept {
+			assert(!structurally_locked());
+			if(count == 0) return invalid_entity;
+			ECRS_ALLOCATION_SCOPE(allocator);
+			if(fpda_size(entity_component_indices) == 0) { // Skip entity zero!
+				fpda_push_back(entity_component_indices, nullptr);
+				fpda_push_back(entity_versions, 1);
+			}
+			entity_t first = fpda_size(entity_component_indices);
+			fpda_grow_and_initialize(entity_component_indices, count, nullptr);
+			fpda_grow_and_initialize(entity_versions, count, 0);
+			return first;
+		}
+
 		entity_t create_entity() noexcept {
+			assert(!structurally_locked());
+			ECRS_ALLOCATION_SCOPE(allocator);
 			if(!freelist || fpda_empty(freelist)) {
 				entity_t e = entity_component_indices ? fpda_size(entity_component_indices) : 0;
 				if(e == 0) fpda_reserve(entity_component_indices, 16);
 				fpda_push_back(entity_component_indices, nullptr);
+				fpda_push_back(entity_versions, e == 0 ? 1 : 0); // Entity zero starts at version one so that invalid_handle never validates
 				if(e == 0) return create_entity(); // Skip entity zero!
 				return e;
 			}
 
 			entity_t e = *fpda_pop_back(freelist);
+			++entity_versions[e]; // Back to an even (alive) version
 			if(entity_component_indices[e])
 				fpda_free_and_null(entity_component_indices[e]);
-			fpda_push_back(entity_component_indices[e], Storage::invalid);
+			fpda_push_back(entity_component_indices[e], Storage::invalid_index);
 			return e;
 		}
 
 		bool release_entity(entity_t e, bool clearMemory = true) noexcept {
-			if(e >= fpda_size(entity_component_indices)) return false;
+			assert(!structurally_locked());
+			if(e >= fpda_size(entity_component_indices) || is_released(e)) return false;
 
 			if(clearMemory && storages && !fpda_empty(storages))
 				for(size_t i = 0, size = fpda_size(storages); i < size; ++i)
 					storages[i].remove(*this, e, i);
+			for(size_t i = 0, size = fpda_size(tags); i < size; ++i)
+				if(tags[i]) set_tag(e, i, false);
 
 			if(entity_component_indices[e])
 				fpda_free_and_null(entity_component_indices[e]);
 
+			++entity_versions[e];
+			ECRS_ALLOCATION_SCOPE(allocator);
 			fpda_push_back(freelist, e);
 			return true;
 		}
+		bool release_entity(Handle h, bool clearMemory = true) noexcept {
+			if(!valid(h)) return false;
+			return release_entity(h.index(), clearMemory);
+		}
+
+		// Releases every entity in the span, each affected storage is compacted in a single (order preserving) pass instead of removing elements one by one
+		void release_entities(std::span<const entity_t> released) noexcept {
+			assert(!structurally_locked());
+			size_t count = entity_count();
+			if(released.empty() || count == 0) return;
+			ScratchArena& arena = scratch_arena();
+			ScratchArena::Scope scope(arena);
+			bool* marked = ECRS_SCRATCH(arena, bool, count);
+			std::memset(marked, 0, count);
+			for(entity_t e: released)
+				if(e != invalid_entity && e < count && !is_released(e)) marked[e] = true;
+
+			for(size_t componentID = 0, size = fpda_size(storages); componentID < size; ++componentID) {
+				auto& storage = storages[componentID];
+				if(storage.element_size == Storage::invalid) continue;
+				bool affected = false;
+				for(entity_t e: released)
+					if(e < count && marked[e] && has_component(e, componentID)) {
+						affected = true;
+						break;
+					}
+				if(!affected) continue;
+
+				size_t group_size = storage.group == Storage::invalid ? 0 : groups[storage.group].size;
+				size_t write = 0, removed_from_group = 0;
+				for(size_t read = 0, storageSize = storage.size(); read < storageSize; ++read) {
+					entity_t e = storage.entities[read];
+					if(e != invalid_entity && marked[e]) {
+						if(read < group_size) ++removed_from_group;
+						continue;
+					}
+					if(write != read) {
+						storage.move_slot(write, read);
+						if(e != invalid_entity) entity_component_indices[e][componentID] = write;
+					}
+					++write;
+				}
+				// NOTE: Removing elements in order keeps a group's members at the front, every storage in the group loses the same members so only update its size once
+				if(storage.group != Storage::invalid && groups[storage.group].components[0] == componentID)
+					groups[storage.group].size -= removed_from_group;
+				storage.truncate(write);
+			}
+
+			for(size_t i = 0, size = fpda_size(tags); i < size; ++i)
+				if(tags[i]) for(entity_t e: released)
+					if(e < count && marked[e]) set_tag(e, i, false);
+
+			ECRS_ALLOCATION_SCOPE(allocator);
+			fpda_reserve(freelist, fpda_size(freelist) + released.size());
+			for(entity_t e: released) {
+				if(e >= count || !marked[e]) continue; // Invalid or duplicate
+				marked[e] = false;
+				if(entity_component_indices[e])
+					fpda_free_and_null(entity_component_indices[e]);
+				++entity_versions[e];
+				fpda_push_back(freelist, e);
+			}
+		}
+
+		inline Handle handle(entity_t e) const noexcept {
+			assert(e < fpda_size(entity_versions));
+			return {e, entity_versions[e]};
+		}
+		inline Handle create_handle() noexcept { return handle(create_entity()); }
+		// Checks if the entity h refers to is still alive (and hasn't been replaced by a newer entity in the same slot)
+		inline bool valid(Handle h) const noexcept {
+			return h.index() < fpda_size(entity_versions) && entity_versions[h.index()] == h.version();
+		}
+		// Checks if e is on the freelist, released entities have odd versions (the version is bumped again when the slot is reused)
+		inline bool is_released(entity_t e) const noexcept {
+			return e < fpda_size(entity_versions) && (entity_versions[e] & 1);
+		}
 
 		#define ECRS_ADD_COMPONENT_COMMON_A(componentID, element_size)\
+			assert(!structurally_locked());\
 			assert(fpda_size(entity_component_indices) > e);\
+			ECRS_ALLOCATION_SCOPE(allocator);\
 			if(!entity_component_indices[e] || fpda_empty(entity_component_indices[e]) || fpda_size(entity_component_indices[e]) <= componentID)\
-				fpda_grow_to_size_and_initialize(entity_component_indices[e], componentID + 1, Storage::invalid);
-		#define ECRS_ADD_COMPONENT_COMMON_B(componentID, element_size)\
-			auto& storage = get_storage(componentID, element_size);\
+				fpda_grow_to_size_and_initialize(entity_component_indices[e], componentID + 1, Storage::invalid_index);
+		#define ECRS_ADD_COMPONENT_COMMON_B(componentID, element_size, alignment)\
+			auto& storage = get_storage(componentID, element_size, alignment);\
 			entity_component_indices[e][componentID] = storage.size()
 		void* add_component(entity_t e, component_t componentID, size_t element_size) noexcept {
+			ECRS_ZONE_SCOPED_NAMED("ecrs::add_component");
+			ECRS_COUNT(ComponentAdds);
 			ECRS_ADD_COMPONENT_COMMON_A(componentID, element_size);
-			ECRS_ADD_COMPONENT_COMMON_B(componentID, element_size);
-			return storage.get_or_allocate(e);
+			ECRS_ADD_COMPONENT_COMMON_B(componentID, element_size, 0);
+			auto res = storage.get_or_allocate(entity_component_indices[e][componentID]);
+			storage.entities[entity_component_indices[e][componentID]] = e;
+			storage.mark_added(entity_component_indices[e][componentID], change_tick);
+			if(storage.group != Storage::invalid && enter_group(storage.group, e))
+				return storage.get(entity_component_indices[e][componentID]); // Entering the group moved the component
+			return res;
 		}
 		template<typename T, size_t Unique = 0>
 		T& add_component(entity_t e) noexcept {
+			ECRS_ZONE_SCOPED_NAMED("ecrs::add_component");
+			ECRS_COUNT(ComponentAdds);
 			component_t componentID = get_global_component_id<T, Unique>();
-			{
+			if constexpr(is_tag_v<T>) {
+				assert(fpda_size(entity_component_indices) > e);
+				set_tag(e, componentID);
+				return detail::tag_value<T>();
+			} else {
 				ECRS_ADD_COMPONENT_COMMON_A(componentID, sizeof(T));
-				if constexpr(is_tag_v<T>) {
-					entity_component_indices[e][componentID] = true; // Mark the tag as present
-					return detail::tag_value<T>();
-				}
-				ECRS_ADD_COMPONENT_COMMON_B(componentID, sizeof(T));
+				ECRS_ADD_COMPONENT_COMMON_B(componentID, sizeof(T), storage_alignment_v<T>);
 				auto& res = storage.template get_or_allocate<T>(entity_component_indices[e][componentID]);
+				storage.entities[entity_component_indices[e][componentID]] = e;
+				storage.mark_added(entity_component_indices[e][componentID], change_tick);
 
 				if constexpr(detail::is_with_entity_v<T>)
-					res.entity = e;
+					res.set_entity(*this, e);
+				if(storage.group != Storage::invalid && enter_group(storage.group, e))
+					return storage.template get<T>(entity_component_indices[e][componentID]); // Entering the group moved the component
 				return res;
 			}
 		}
@@ -353,8 +1022,9 @@ namespace ecrs {
 		template<typename Tcomponent, size_t Unique = 0>
 		bool remove_component(entity_t e) noexcept {
 			if constexpr(is_tag_v<Tcomponent>) {
-				if(has_component<Tcomponent, Unique>(e))
-					entity_component_indices[e][get_global_component_id<Tcomponent, Unique>()] = Storage::invalid;
+				bool had = has_component<Tcomponent, Unique>(e);
+				set_tag(e, get_global_component_id<Tcomponent, Unique>(), false);
+				return had;
 			} else return get_storage<Tcomponent, Unique>().template remove<Tcomponent>(*this, e);
 		}
 
@@ -363,7 +1033,7 @@ namespace ecrs {
 			assert(e < fpda_size(entity_component_indices));\
 			assert(entity_component_indices[e]);\
 			assert(fpda_size(entity_component_indices[e]) > componentID);\
-			assert(entity_component_indices[e][componentID] != Storage::invalid);
+			assert(entity_component_indices[e][componentID] != Storage::invalid_index);
 		void* get_component(entity_t e, component_t componentID) noexcept {
 			ECRS_GET_COMPONENT_COMMON(componentID);
 			return get_storage(componentID).get(entity_component_indices[e][componentID]);
@@ -386,16 +1056,45 @@ namespace ecrs {
 			ECRS_GET_COMPONENT_COMMON(componentID);
 			return get_storage(componentID).template get<T>(entity_component_indices[e][componentID]);
 		}
+
+		// Mutable access which marks the component as changed during the current tick (only matters for tracked storages)
+		void* modify_component(entity_t e, component_t componentID) noexcept {
+			ECRS_GET_COMPONENT_COMMON(componentID);
+			auto& storage = get_storage(componentID);
+			storage.mark_changed(entity_component_indices[e][componentID], change_tick);
+			return storage.get(entity_component_indices[e][componentID]);
+		}
+		template<typename T, size_t Unique = 0>
+		T& modify_component(entity_t e) noexcept {
+			static_assert(!is_tag_v<T>, "Tags can't change");
+			component_t componentID = get_global_component_id<T, Unique>();
+			ECRS_GET_COMPONENT_COMMON(componentID);
+			auto& storage = get_storage(componentID);
+			storage.mark_changed(entity_component_indices[e][componentID], change_tick);
+			return storage.template get<T>(entity_component_indices[e][componentID]);
+		}
 		#undef ECRS_GET_COMPONENT_COMMON
 
+		// Starts recording when T's components are added and changed, so queries can filter with added<T> and changed<T>
+		template<typename T, size_t Unique = 0>
+		inline void track_changes() noexcept {
+			static_assert(!is_tag_v<T>, "Tags don't have storages to track");
+			get_storage<T, Unique>().make_tracked(change_tick);
+		}
+		// Ends the current tick and returns it, anything added or changed afterwards counts as added/changed since the returned tick
+		//  (ie a system remembers advance_tick()'s result after it runs and passes it to its queries next time)
+		inline size_t advance_tick() noexcept { return change_tick++; }
+
 		inline bool has_component(entity_t e, component_t componentID) const noexcept {
-			return entity_component_indices && fpda_size(entity_component_indices) > e
+			bool indexed = entity_component_indices && fpda_size(entity_component_indices) > e
 				&& entity_component_indices[e] && fpda_size(entity_component_indices[e]) > componentID
-				&& entity_component_indices[e][componentID] != Storage::invalid;
+				&& entity_component_indices[e][componentID] != Storage::invalid_index;
+			return indexed || has_tag(e, componentID); // NOTE: Tags are never in the index
 		}
 		template<typename T, size_t Unique = 0>
 		inline bool has_component(entity_t e) const noexcept {
-			return has_component(e, get_global_component_id<T, Unique>());
+			if constexpr(is_tag_v<T>) return has_tag(e, get_global_component_id<T, Unique>());
+			else return has_component(e, get_global_component_id<T, Unique>());
 		}
 
 		void* get_or_add_component(entity_t e, component_t componentID, size_t element_size) noexcept {
@@ -410,20 +1109,154 @@ namespace ecrs {
 			else return add_component<T, Unique>(e);
 		}
 
+		// Adds T to every entity (none of which may already have it), values is either empty (default construct) or parallel to entities
+		//  The storage is grown once for the whole batch
+		template<typename T, size_t Unique = 0>
+		void add_components(std::span<const entity_t> entities, std::span<const T> values = {}) noexcept {
+			assert(!structurally_locked());
+			assert(values.empty() || values.size() == entities.size());
+			component_t componentID = get_global_component_id<T, Unique>();
+			if constexpr(is_tag_v<T>) {
+				for(entity_t e: entities) {
+					assert(fpda_size(entity_component_indices) > e);
+					set_tag(e, componentID);
+				}
+				return;
+			} else {
+				ECRS_ALLOCATION_SCOPE(allocator);
+				for(entity_t e: entities) {
+					assert(fpda_size(entity_component_indices) > e);
+					assert(!has_component(e, componentID));
+					if(fpda_size(entity_component_indices[e]) <= componentID)
+						fpda_grow_to_size_and_initialize(entity_component_indices[e], componentID + 1, Storage::invalid_index);
+				}
+
+				auto& storage = get_storage(componentID, sizeof(T), storage_alignment_v<T>);
+				size_t first = storage.size();
+				if(values.empty()) storage.template allocate<T>(entities.size());
+				else if(storage.chunked()) {
+					storage.grow_uninitialized(entities.size());
+					for(size_t i = 0; i < values.size(); ++i)
+						new(&storage.template get<T>(first + i)) T(values[i]);
+				} else if constexpr(std::is_trivially_copyable_v<T>) {
+					storage.grow_uninitialized(entities.size());
+					std::memcpy(storage.template data<T>() + first, values.data(), values.size_bytes());
+				} else {
+					storage.grow_uninitialized(entities.size());
+					T* data = storage.template data<T>() + first;
+					for(size_t i = 0; i < values.size(); ++i)
+						new(data + i) T(values[i]);
+				}
+
+				for(size_t i = 0; i < entities.size(); ++i) {
+					entity_component_indices[entities[i]][componentID] = first + i;
+					storage.entities[first + i] = entities[i];
+					storage.mark_added(first + i, change_tick);
+					if constexpr(detail::is_with_entity_v<T>)
+						storage.template get<T>(first + i).set_entity(*this, entities[i]);
+				}
+				if(storage.group != Storage::invalid)
+					for(entity_t e: entities)
+						enter_group(storage.group, e);
+			}
+		}
+
+		// Creates a group owning the given components (which must already have storages and may not belong to another group), returns the group's index
+		size_t create_group(fp_view(component_t) components) noexcept {
+			assert(!structurally_locked());
+			ECRS_ALLOCATION_SCOPE(allocator);
+			size_t group = fpda_size(groups);
+			fpda_push_back(groups, Group{});
+			Storage* smallest = nullptr;
+			fp_view_iterate_named(component_t, components, id) {
+				assert(fpda_size(storages) > *id && storages[*id].element_size != Storage::invalid);
+				assert(storages[*id].group == Storage::invalid); // A storage can only be owned by a single group
+				assert(!storages[*id].chunked()); // Groups are walked as contiguous arrays
+				storages[*id].group = group;
+				fpda_push_back(groups[group].components, *id);
+				if(!smallest || storages[*id].size() < smallest->size())
+					smallest = storages + *id;
+			}
+
+			// Pull every entity which already has all of the components into the group
+			if(smallest) for(size_t i = 0, size = smallest->size(); i < size; ++i)
+				if(smallest->entities[i] != invalid_entity)
+					enter_group(group, smallest->entities[i]);
+			return group;
+		}
+		template<typename... Tcomponents>
+		size_t create_group() noexcept {
+			static_assert(sizeof...(Tcomponents) > 0);
+			static_assert((!is_tag_v<Tcomponents> && ...), "Tags don't have storages and thus can't be grouped");
+			(get_storage<Tcomponents>(), ...);
+			component_t* ids = fp_alloca(component_t, sizeof...(Tcomponents));
+			size_t i = 0;
+			((ids[i++] = get_global_component_id<Tcomponents>()), ...);
+			return create_group(fp_view_make_full(component_t, ids));
+		}
+
+		inline size_t group_size(size_t group) const noexcept {
+			assert(group < fpda_size(groups));
+			return groups[group].size;
+		}
+
+		// Calls f(entity, components...) for every entity in the group (a linear walk over the front of each storage)
+		template<typename... Tcomponents, typename F>
+		void each_in_group(size_t group, const F& f) noexcept {
+			assert(group < fpda_size(groups));
+			assert(((get_storage<Tcomponents>().group == group) && ...));
+			Storage& first = get_storage<detail::nth_type<0, Tcomponents...>>();
+			std::tuple<Tcomponents*...> data = {get_storage<Tcomponents>().template data<Tcomponents>()...};
+			for(size_t i = 0, size = groups[group].size; i < size; ++i)
+				f(first.entities[i], std::get<Tcomponents*>(data)[i]...);
+		}
+
+		// Moves e into the group if it has every component the group owns, returns true if any component was moved
+		bool enter_group(size_t group, entity_t e) noexcept {
+			auto& g = groups[group];
+			if(!in_group_candidate(g, e)) return false;
+			if(entity_component_indices[e][g.components[0]] < g.size) return false; // Already grouped
 
+			fp_iterate_named(g.components, id) {
+				size_t index = entity_component_indices[e][*id];
+				if(index != g.size) storages[*id].swap(*this, *id, index, g.size);
+			}
+			++g.size;
+			return true;
+		}
+		// Moves e out of the group (to just past its end), returns true if e was grouped
+		bool leave_group(size_t group, entity_t e) noexcept {
+			auto& g = groups[group];
+			if(!in_group_candidate(g, e)) return false;
+			if(entity_component_indices[e][g.components[0]] >= g.size) return false; // Not grouped
+
+			--g.size;
+			fp_iterate_named(g.components, id) {
+				size_t index = entity_component_indices[e][*id];
+				if(index != g.size) storages[*id].swap(*this, *id, index, g.size);
+			}
+			return true;
+		}
 
 	protected:
+		inline bool in_group_candidate(const Group& g, entity_t e) const noexcept {
+			fp_iterate_named(g.components, id)
+				if(!has_component(e, *id)) return false;
+			return true;
+		}
+
 		template<typename Tcomponent, size_t Unique = 0>
 		struct NotifySwapOp {
 			inline void operator()(TrivialModule& self, entity_t a, entity_t b) const {
 				// if constexpr(!detail::has_swap_entities<Tcomponent>) return true;
 				auto& storage = self.get_storage<Tcomponent, Unique>();
-				Tcomponent* data = storage.template data<Tcomponent>();
-				for(size_t i = storage.size(); i--; ) {
-					// This commented code runs half as fast as the current code!
-					// if(!self.has_component<Tcomponent>(i)) continue;
-					// Tcomponent::swap_entities(*self.get_component<Tcomponent>(i), a, b);
-					Tcomponent::swap_entities(data[i], self, a, b);
+				for(size_t c = storage.chunk_count(); c--; ) {
+					auto chunk = storage.template chunk<Tcomponent>(c);
+					for(size_t i = chunk.size(); i--; )
+						// This commented code runs half as fast as the current code!
+						// if(!self.has_component<Tcomponent>(i)) continue;
+						// Tcomponent::swap_entities(*self.get_component<Tcomponent>(i), a, b);
+						Tcomponent::swap_entities(chunk[i], self, a, b);
 				}
 			}
 		};
@@ -431,9 +1264,37 @@ namespace ecrs {
 		void swap_entities(entity_t a, std::optional<entity_t> _b = {}) {
 			entity_t b = _b.value_or(fpda_size(entity_component_indices) - 1);
 
+			assert(!structurally_locked());
 			assert(a < fpda_size(entity_component_indices));
 			assert(b < fpda_size(entity_component_indices));
 			std::swap(entity_component_indices[a], entity_component_indices[b]);
+			relink_entity(a);
+			relink_entity(b);
+			for(size_t i = 0, size = fpda_size(tags); i < size; ++i) // Tags live in bitsets rather than the indices
+				if(bool hasA = has_tag(a, i), hasB = has_tag(b, i); tags[i] && hasA != hasB) {
+					set_tag(a, i, hasB);
+					set_tag(b, i, hasA);
+				}
+		}
+
+		// Points the slot of every component e owns back at e
+		void relink_entity(entity_t e) noexcept {
+			if(!entity_component_indices[e]) return;
+			for(size_t i = 0, size = std::min(fpda_size(entity_component_indices[e]), fpda_size(storages)); i < size; ++i) {
+				size_t index = entity_component_indices[e][i];
+				if(index == Storage::invalid_index || storages[i].element_size == Storage::invalid) continue; // NOTE: Only initialized storages have slots to point back
+				if(index < fpda_size(storages[i].entities))
+					storages[i].entities[index] = e;
+			}
+		}
+
+		// Rebuilds every storage's slot -> entity map from entity_component_indices (useful after manually filling the indices, for example when deserializing)
+		void relink_all_entities() noexcept {
+			fp_iterate_named(storages, storage)
+				for(size_t i = 0, size = fpda_size(storage->entities); i < size; ++i)
+					storage->entities[i] = invalid_entity;
+			for(entity_t e = 0, size = entity_count(); e < size; ++e)
+				relink_entity(e);
 		}
 
 		template<typename... Tcomponents2notify>
@@ -450,7 +1311,9 @@ namespace ecrs {
 #define ECRS_REORDER_ENTITIES_COMMON(_order, SWAP_ENTITIES)\
 			size_t size = fp_view_size(_order);\
 			assert(size == entity_count()); /* Require order to have an entry for every element in the array */\
-			auto swaps = fp_alloca(size_t, size);\
+			ScratchArena& arena = scratch_arena();\
+			ScratchArena::Scope scope(arena);\
+			auto swaps = ECRS_SCRATCH(arena, size_t, size);\
 			/* Transpose the order (it now stores what needs to be swapped with what) */\
 			for(size_t i = 0; i < size; ++i)\
 				swaps[*fp_view_access(size_t, order, i)] = i;\
@@ -507,9 +1370,11 @@ namespace ecrs {
 			get_storage(component_id).sort_monotonic(*this, component_id);
 		}
 
+		// NOTE: parallel::make_all_monotonic sorts different storages on different threads at once
 		void make_all_monotonic() {
 			fp_iterate_named(storages, storage) {
 				if(storage->element_size == Storage::invalid) continue; // Only initialized storages can be made monotonic
+				if(storage->group != Storage::invalid) continue; // Grouped storages have an order they need to maintain
 				auto id = fp_iterate_calculate_index(storages, storage);
 				storage->sort_monotonic(*this, id);
 			}
@@ -521,6 +1386,7 @@ namespace ecrs {
 		bool should_leak = false; // Useful when shutting down, if we are closing we can just leave memory cleanup to the operating system for a bit of added performance!
 
 		Module() = default;
+		Module(Allocator& allocator) { use_allocator(allocator); }
 		Module(const Module&) = delete; // Storages need to become copyable to change this...
 		Module(Module&& o) { *this = std::move(o); }
 		Module& operator=(const Module& o) = delete;
@@ -529,6 +1395,12 @@ namespace ecrs {
 			entity_component_indices = std::exchange(o.entity_component_indices, nullptr);
 			storages = std::exchange(o.storages, nullptr);
 			freelist = std::exchange(o.freelist, nullptr);
+			entity_versions = std::exchange(o.entity_versions, nullptr);
+			groups = std::exchange(o.groups, nullptr);
+			tags = std::exchange(o.tags, nullptr);
+			change_tick = std::exchange(o.change_tick, 1);
+			scratch = std::exchange(o.scratch, {});
+			allocator = std::exchange(o.allocator, nullptr);
 			return *this;
 		}
 
@@ -540,11 +1412,8 @@ namespace ecrs {
 	namespace detail {
 		// Gets the entity associated with a specific component index
 		inline entity_t get_entity(TrivialModule& module, size_t index, size_t component_id) {
-			assert(module.entity_component_indices);
-			for(size_t e = 0; e < fpda_size(module.entity_component_indices); ++e)
-				if(fpda_size(module.entity_component_indices[e]) > component_id && module.entity_component_indices[e][component_id] == index)
-					return e;
-			return invalid_entity;
+			if(fpda_size(module.storages) <= component_id) return invalid_entity;
+			return module.storages[component_id].get_entity(index);
 		}
 		template<typename Tcomponent, size_t Unique = 0>
 		inline entity_t get_entity(TrivialModule& module, size_t index) {
@@ -554,16 +1423,16 @@ namespace ecrs {
 		template<typename Tcomponent, size_t Unique = 0>
 		inline entity_t get_entity(Storage& storage, TrivialModule& module, size_t index, std::optional<size_t> component_id = {}) {
 			if constexpr(detail::is_with_entity_v<Tcomponent>)
-				return (storage.data<Tcomponent>() + index)->entity;
-			else if constexpr(std::is_same_v<Tcomponent, detail::void_like>)
-				return get_entity(module, index, component_id.value());
-			else return get_entity<Tcomponent, Unique>(module, index);
+				return entity_t(storage.get<Tcomponent>(index).entity);
+			else return storage.get_entity(index);
 		}
 	}
 
 
 	template<typename Tcomponent, size_t Unique = 0>
 	inline bool swap_impl(Storage* self, TrivialModule& module, size_t a, std::optional<size_t> _b = {}, bool swap_if_one_elementless = false, std::optional<size_t> _component_id = {}) {
+		ECRS_ZONE_SCOPED_NAMED("ecrs::Storage::swap");
+		ECRS_COUNT(Swaps);
 		size_t b = _b.value_or(self->size() - 1);
 		size_t component_id = _component_id.value_or(get_global_component_id<Tcomponent, Unique>());
 		entity_t eA = detail::get_entity<Tcomponent, Unique>(*self, module, a, component_id);
@@ -576,15 +1445,16 @@ namespace ecrs {
 		if constexpr(std::is_same_v<Tcomponent, detail::void_like>)
 			self->swap(a, b);
 		else self->swap<Tcomponent>(a, b);
+		ECRS_ALLOCATION_SCOPE(module.allocator); // Either entity's indices may need to grow
 		if (swap_if_one_elementless && eA == invalid_entity) {
 			if(auto idx = module.entity_component_indices[eB]; fpda_size(idx) <= component_id) {
-				fpda_grow_to_size_and_initialize(idx, component_id + 1, Storage::invalid);
+				fpda_grow_to_size_and_initialize(idx, component_id + 1, Storage::invalid_index);
 				module.entity_component_indices[eB] = idx;
 			}
 			module.entity_component_indices[eB][component_id] = a;
 		} else if (swap_if_one_elementless && eB == invalid_entity) {
 			if(auto idx = module.entity_component_indices[eA]; fpda_size(idx) <= component_id) {
-				fpda_grow_to_size_and_initialize(idx, component_id + 1, Storage::invalid);
+				fpda_grow_to_size_and_initialize(idx, component_id + 1, Storage::invalid_index);
 				module.entity_component_indices[eA] = idx;
 			}
 			module.entity_component_indices[eA][component_id] = b;
@@ -604,47 +1474,92 @@ namespace ecrs {
 
 
 	inline bool Storage::remove(TrivialModule& module, entity_t e, size_t component_id) {
+		ECRS_ZONE_SCOPED_NAMED("ecrs::Storage::remove");
+		ECRS_COUNT(ComponentRemoves);
+		assert(!module.structurally_locked());
 		size_t size = this->size();
 		if(size == 0 || !module.entity_component_indices || e >= fpda_size(module.entity_component_indices)) return false;
 
 		auto& indices = module.entity_component_indices[e];
 		if(fpda_size(indices) <= component_id) return false;
+		size_t index = indices[component_id];
+		if(index == invalid_index || index >= size) return false;
+		if(group != invalid && module.leave_group(group, e)) {
+			index = indices[component_id];
+			// NOTE: leave_group only moves elements within the storage, so the size is unchanged
+		}
 
-		for(e = 0; e < fpda_size(module.entity_component_indices); ++e)
-			if(fpda_size(module.entity_component_indices[e]) > component_id
-				&& module.entity_component_indices[e][component_id] == size - 1
-			)
-				break;
-		if(e >= fpda_size(module.entity_component_indices)) return false;
-
-		swap(indices[component_id]);
-		if(fpda_size(module.entity_component_indices[e]) <= component_id) fpda_grow_to_size_and_initialize(module.entity_component_indices[e], component_id + 1, Storage::invalid);
-		std::swap(indices[component_id], module.entity_component_indices[e][component_id]);
-		fpda_delete_range(raw, (size - 1) * element_size, element_size); // TODO: Could we pop back instead?
-		indices[component_id] = invalid;
+		// Move the last element into the removed element's slot and point its owner at the new location
+		entity_t last = entities[size - 1];
+		swap(index);
+		if(last != e && last != invalid_entity && fpda_size(module.entity_component_indices[last]) > component_id
+			&& module.entity_component_indices[last][component_id] == size - 1
+		)
+			module.entity_component_indices[last][component_id] = index;
+		pop_back();
+		indices[component_id] = invalid_index;
 		return true;
 	}
 
 
+	template<typename Tcomponent /*= detail::void_like*/>
+	inline void Storage::permute(TrivialModule& module, size_t component_id, const size_t* order) {
+		assert(group == invalid); // Permuting a grouped storage would break the group
+		assert(!module.structurally_locked());
+		size_t size = this->size();
+		if(size <= 1) return;
+
+		// Gather every array into scratch (in its new order) then copy it back
+		ScratchArena& arena = module.scratch_arena();
+		ScratchArena::Scope scope(arena);
+		if constexpr(std::is_same_v<Tcomponent, detail::void_like> || std::is_trivially_copyable_v<Tcomponent>) {
+			uint8_t* scratch = ECRS_SCRATCH(arena, uint8_t, size * element_size);
+			for(size_t i = 0; i < size; ++i)
+				std::memcpy(scratch + i * element_size, get(order[i]), element_size);
+			if(!chunked()) std::memcpy(raw + offset, scratch, size * element_size);
+			else for(size_t i = 0; i < size; ++i)
+				std::memcpy(get(i), scratch + i * element_size, element_size);
+		} else {
+			assert(sizeof(Tcomponent) == element_size);
+			uint8_t* bytes = ECRS_SCRATCH(arena, uint8_t, size * sizeof(Tcomponent) + alignof(Tcomponent));
+			auto gathered = (Tcomponent*)(bytes + (alignof(Tcomponent) - (uintptr_t)bytes % alignof(Tcomponent)) % alignof(Tcomponent));
+			for(size_t i = 0; i < size; ++i)
+				new(gathered + i) Tcomponent(std::move(get<Tcomponent>(order[i])));
+			for(size_t i = 0; i < size; ++i) {
+				get<Tcomponent>(i) = std::move(gathered[i]);
+				gathered[i].~Tcomponent();
+			}
+		}
+		uint8_t* scratch = ECRS_SCRATCH(arena, uint8_t, size * sizeof(size_t));
+
+		constexpr static auto gather = []<typename T>(T* array, const size_t* order, uint8_t* scratch, size_t size) {
+			T* gathered = (T*)scratch;
+			for(size_t i = 0; i < size; ++i)
+				gathered[i] = array[order[i]];
+			std::memcpy(array, gathered, size * sizeof(T));
+		};
+		gather(entities, order, scratch, size);
+		if(tracked()) {
+			gather(added_ticks, order, scratch, size);
+			gather(changed_ticks, order, scratch, size);
+		}
+
+		for(size_t i = 0; i < size; ++i)
+			if(entity_t e = entities[i]; e != invalid_entity)
+				module.entity_component_indices[e][component_id] = i;
+	}
+
 	template<typename Tcomponent, size_t Unique = 0>
 	inline void reorder_impl(Storage* self, TrivialModule& module, fp_view(size_t) order, std::optional<size_t> _component_id = {}) {
+		ECRS_ZONE_SCOPED_NAMED("ecrs::Storage::reorder");
+		ECRS_COUNT(Reorders);
 		assert(fp_view_size(order) == self->size()); // Require order to have an entry for every element in the array
+		assert(self->group == Storage::invalid); // Reordering a grouped storage would break the group
+		assert(!module.structurally_locked());
 		if(self->size() <= 1) return; // Zero or one elements are always sorted
 		size_t component_id = _component_id.value_or(get_global_component_id<Tcomponent, Unique>());
 
-		size_t* swaps = fp_alloca(size_t, fp_view_size(order));
-		// Transpose the order (it now stores what needs to be swapped with what)
-		for(size_t i = 0; i < fp_view_size(order); i++)
-			swaps[*fp_view_access(size_t, order, i)] = i;
-
-		// Update the data storage and book keeping
-		for(size_t i = 0; i < fp_view_size(order); ++i)
-			while(swaps[i] != i) {
-				if constexpr(std::is_same_v<Tcomponent, detail::void_like>)
-					self->swap(module, component_id, swaps[i], i);
-				else self->swap<Tcomponent, Unique>(module, swaps[i], i);
-				std::swap(swaps[swaps[i]], swaps[i]);
-			}
+		self->template permute<Tcomponent>(module, component_id, fp_view_data(size_t, order));
 	}
 	inline void Storage::reorder(TrivialModule& module, size_t component_id, fp_view(size_t) order) {
 		reorder_impl<detail::void_like, 0>(this, module, order, component_id);
@@ -655,24 +1570,36 @@ namespace ecrs {
 	}
 
 
-	template<typename Tcomponent, typename F, bool with_entities /*= false*/, size_t Unique /*= 0*/>
-	void sort_impl(Storage* self, TrivialModule& module, const F& _comparator, std::optional<size_t> _component_id = {}) {
+	namespace detail {
+		// Sorts sort_impl's list of indices (see parallel::sort for one which spreads the work across a thread pool)
+		struct sequential_sort {
+			template<typename Compare>
+			inline void operator()(size_t* order, size_t size, const Compare& comparator, ScratchArena& arena) const {
+				std::sort(order, order + size, comparator);
+			}
+		};
+	}
+
+	template<typename Tcomponent, typename F, bool with_entities /*= false*/, size_t Unique /*= 0*/, typename Sorter = detail::sequential_sort>
+	void sort_impl(Storage* self, TrivialModule& module, const F& _comparator, std::optional<size_t> _component_id = {}, const Sorter& sorter = {}) {
+		ECRS_ZONE_SCOPED_NAMED("ecrs::Storage::sort");
+		ECRS_COUNT(Sorts);
 		size_t component_id = _component_id.value_or(get_global_component_id<Tcomponent, Unique>());
 		// Create a list of indices
 		size_t size = self->size();
 		if(size <= 1) return; // Zero or one elements are always sorted
-		size_t* order = fp_alloca(size_t, size);
-		std::iota(order, fp_end(order), 0);
+		ScratchArena& arena = module.scratch_arena();
+		ScratchArena::Scope scope(arena);
+		size_t* order = ECRS_SCRATCH(arena, size_t, size);
+		std::iota(order, order + size, 0);
 
-		constexpr static auto data = std::is_same_v<Tcomponent, detail::void_like> ? +[](Storage* self, size_t i) -> void* {
-			return ((char*)self->raw) + i * self->element_size;
-		} : +[](Storage* self, size_t i) -> void* {
-			return self->data<Tcomponent>() + i;
+		constexpr static auto data = +[](Storage* self, size_t i) -> void* {
+			return self->get(i);
 		};
 
 		// Sort the list of indices into the correct order (possibly alongside a list of entities)
 		if constexpr(with_entities) {
-			entity_t* entities = fp_alloca(entity_t, size);
+			entity_t* entities = ECRS_SCRATCH(arena, entity_t, size);
 			for(size_t i = size; i--; )
 				entities[i] = detail::get_entity<Tcomponent, Unique>(*self, module, i, component_id);
 
@@ -682,7 +1609,7 @@ namespace ecrs {
 				return _comparator(a, entities[_a], b, entities[_b]);
 			};
 
-			std::sort(order, fp_end(order), comparator);
+			sorter(order, size, comparator, arena);
 		} else {
 			auto comparator = [self, &_comparator](size_t _a, size_t _b) {
 				void* a = data(self, _a);
@@ -690,13 +1617,64 @@ namespace ecrs {
 				return _comparator(a, b);
 			};
 
-			std::sort(order, fp_end(order), comparator);
+			sorter(order, size, comparator, arena);
 		}
 
 		if constexpr(std::is_same_v<Tcomponent, detail::void_like>)
-			self->reorder(module, component_id, fp_view_make_full(size_t, order));
-		else self->reorder<Tcomponent, Unique>(module, fp_view_make_full(size_t, order));
+			self->reorder(module, component_id, fp_view_make(size_t, order, size));
+		else self->reorder<Tcomponent, Unique>(module, fp_view_make(size_t, order, size));
 	}
+	namespace detail {
+		// Radix sorts the storage by key_of(slot), a no-op if the keys are already in order
+		template<typename Tcomponent, typename F>
+		void radix_sort_storage(Storage* self, TrivialModule& module, size_t component_id, const F& key_of) {
+			ECRS_ZONE_SCOPED_NAMED("ecrs::Storage::radix_sort");
+			ECRS_COUNT(Sorts);
+			size_t size = self->size();
+			if(size <= 1) return; // Zero or one elements are always sorted
+			using K = decltype(radix_key(key_of(0)));
+
+			ScratchArena& arena = module.scratch_arena();
+			ScratchArena::Scope scope(arena);
+			K* keys = ECRS_SCRATCH(arena, K, 2 * size);
+			bool sorted = true;
+			for(size_t i = 0; i < size; ++i) {
+				keys[i] = radix_key(key_of(i));
+				sorted &= i == 0 || keys[i - 1] <= keys[i];
+			}
+			if(sorted) return;
+
+			size_t* order = ECRS_SCRATCH(arena, size_t, 2 * size);
+			std::iota(order, order + size, 0);
+			radix_sort(keys, order, keys + size, order + size, size);
+			self->template permute<Tcomponent>(module, component_id, order);
+		}
+	}
+	template<typename Tcomponent, typename F, size_t Unique /*= 0*/>
+	inline void Storage::sort_by_key(TrivialModule& module, const F& key) {
+		using Key = std::remove_cvref_t<std::invoke_result_t<const F&, const Tcomponent&>>;
+		if constexpr(detail::radix_sortable<Key>)
+			detail::radix_sort_storage<Tcomponent>(this, module, get_global_component_id<Tcomponent, Unique>(), [this, &key](size_t i) {
+				return key(std::as_const(*this).get<Tcomponent>(i));
+			});
+		else {
+			auto comparator = [&key](Tcomponent* a, Tcomponent* b) {
+				return std::less<Key>{}(key(*a), key(*b));
+			};
+			sort<Tcomponent, decltype(comparator), false, Unique>(module, comparator);
+		}
+	}
+	template<typename Tcomponent, size_t Unique /*= 0*/>
+	inline void Storage::sort_monotonic(TrivialModule& module) {
+		size_t component_id = get_global_component_id<Tcomponent, Unique>();
+		detail::radix_sort_storage<Tcomponent>(this, module, component_id, [&](size_t i) {
+			return detail::get_entity<Tcomponent, Unique>(*this, module, i, component_id);
+		});
+	}
+	inline void Storage::sort_monotonic(TrivialModule& module, size_t component_id) {
+		detail::radix_sort_storage<detail::void_like>(this, module, component_id, [this](size_t i) { return entities[i]; });
+	}
+
 	template<typename F, bool with_entities>
 	inline void Storage::sort(TrivialModule& module, size_t component_id, const F& comparator) {
 		sort_impl<detail::void_like, F, with_entities, 0>(this, module, comparator, component_id);
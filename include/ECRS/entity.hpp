@@ -26,6 +26,7 @@ namespace ecrs {
 
 		Entity() : entity(invalid_entity) {}
 		Entity(entity_t e) : entity(e) {}
+		Entity(Handle h) : entity(h.index()) {}
 		Entity(const Entity&) = default;
 		Entity(Entity&&) = default;
 		Entity& operator=(const Entity&) = default;
@@ -46,6 +47,22 @@ namespace ecrs {
 			return create(*current_module);
 		}
 
+		inline static Handle create_handle(TrivialModule& module) noexcept {
+			return module.create_handle();
+		}
+		inline static Handle create_handle() noexcept {
+			assert(current_module != nullptr);
+			return create_handle(*current_module);
+		}
+
+		inline Handle handle(const TrivialModule& module) const noexcept {
+			return module.handle(entity);
+		}
+		inline Handle handle() const noexcept {
+			assert(current_module != nullptr);
+			return handle(*current_module);
+		}
+
 		inline void release(TrivialModule& module, bool clear_memory = true) noexcept {
 			module.release_entity(entity, clear_memory);
 		}
@@ -168,6 +185,10 @@ namespace ecrs {
 		auto& add_relation(TrivialRelationalModule& module);
 		template<typename R, size_t Unique = 0>
 		auto& add_relation();
+		template<typename R, size_t Unique = 0, typename Trelated>
+		auto& add_relation(TrivialRelationalModule& module, std::initializer_list<Trelated> related);
+		template<typename R, size_t Unique = 0, typename Trelated>
+		auto& add_relation(std::initializer_list<Trelated> related);
 		
 		template<typename R, size_t Unique = 0>
 		bool has_relation(const TrivialRelationalModule& module) const;
@@ -152,7 +152,10 @@ namespace ecrs::kanren {
 			return new_s;
 		}
 
+		// NOTE: Goals are profiled through unify, they are coroutines and zones can't span their suspension points
 		inline static std::optional<Substitutions> unify(const Term& u, const Term& v, Substitutions s) {
+			ECRS_ZONE_SCOPED_NAMED("ecrs::kanren::unify");
+			ECRS_COUNT(Unifications);
 			Term u_ = find(u, s);
 			Term v_ = find(v, s);
 			if (term_equivalence(u_, v_)) return s;
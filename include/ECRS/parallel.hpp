@@ -0,0 +1,255 @@
+#pragma once
+
+#include "adapter.hpp"
+#include "query.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ecrs::parallel {
+
+	// A pool of worker threads, each with its own task queue (idle workers steal from the front of other workers' queues)
+	//  Threads outside the pool share queue zero and help run tasks while they wait
+	struct ThreadPool {
+		using Task = std::function<void()>;
+
+		ThreadPool(size_t worker_count = std::max<size_t>(std::thread::hardware_concurrency(), 2) - 1) : queues(worker_count + 1) {
+			workers.reserve(worker_count);
+			for(size_t i = 0; i < worker_count; ++i)
+				workers.emplace_back([this, i] { worker_loop(i + 1); });
+		}
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+		~ThreadPool() {
+			{
+				std::lock_guard lock(sleep_mutex);
+				stopping = true;
+			}
+			wake.notify_all();
+			for(auto& worker: workers)
+				worker.join();
+		}
+
+		// Number of threads which can run work at once (the workers plus the thread waiting on the work)
+		inline size_t thread_count() const noexcept { return workers.size() + 1; }
+
+		void submit(Task task) {
+			auto& queue = queues[current_queue()];
+			{
+				std::lock_guard lock(queue.mutex);
+				queue.tasks.push_back(std::move(task));
+			}
+			{
+				std::lock_guard lock(sleep_mutex);
+				queued.fetch_add(1, std::memory_order_release);
+			}
+			wake.notify_one();
+		}
+
+		// Runs a single task (newest from our own queue, otherwise the oldest we can steal), returns false if there was nothing to run
+		bool run_one() {
+			Task task;
+			size_t own = current_queue();
+			if(!pop(own, task, true))
+				for(size_t i = 1, size = queues.size(); i < size; ++i)
+					if(pop((own + i) % size, task, false)) break;
+			if(!task) return false;
+			task();
+			return true;
+		}
+
+		// Runs tasks until done returns true
+		template<typename F>
+		void help_until(const F& done) {
+			while(!done())
+				if(!run_one()) std::this_thread::yield();
+		}
+
+		static ThreadPool& global() {
+			static ThreadPool pool;
+			return pool;
+		}
+
+	protected:
+		struct Queue {
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+
+		std::vector<Queue> queues; // Index zero is shared by threads outside the pool
+		std::vector<std::thread> workers;
+		std::atomic<size_t> queued = 0;
+		bool stopping = false;
+		std::mutex sleep_mutex;
+		std::condition_variable wake;
+
+		static inline thread_local const ThreadPool* current_pool = nullptr;
+		static inline thread_local size_t current_index = 0;
+		inline size_t current_queue() const noexcept { return current_pool == this ? current_index : 0; }
+
+		bool pop(size_t index, Task& out, bool newest) {
+			auto& queue = queues[index];
+			std::lock_guard lock(queue.mutex);
+			if(queue.tasks.empty()) return false;
+			if(newest) {
+				out = std::move(queue.tasks.back());
+				queue.tasks.pop_back();
+			} else {
+				out = std::move(queue.tasks.front());
+				queue.tasks.pop_front();
+			}
+			queued.fetch_sub(1, std::memory_order_acq_rel);
+			return true;
+		}
+
+		void worker_loop(size_t index) {
+			current_pool = this;
+			current_index = index;
+			while(true) {
+				if(run_one()) continue;
+				std::unique_lock lock(sleep_mutex);
+				wake.wait(lock, [this] { return stopping || queued.load(std::memory_order_acquire) > 0; });
+				if(stopping && queued.load(std::memory_order_acquire) == 0) return;
+			}
+		}
+	};
+
+	// Marks the module as structurally locked for its lifetime (entities and components may not be created, destroyed, or moved)
+	struct StructuralLock {
+		TrivialModule& module;
+		StructuralLock(TrivialModule& module) noexcept : module(module) { ++module.structural_locks; }
+		~StructuralLock() noexcept { --module.structural_locks; }
+	};
+
+	// Splits [0, size) into chunks of (at most) grain elements and calls f(begin, end) for each chunk across the pool, returns once every chunk has finished
+	//  A grain of zero picks a chunk size which gives each thread a few chunks to balance between
+	template<typename F>
+	void for_each_chunk(size_t size, const F& f, size_t grain = 0, ThreadPool& pool = ThreadPool::global()) {
+		if(size == 0) return;
+		if(grain == 0) grain = std::max<size_t>(size / (pool.thread_count() * 4), 64);
+		size_t chunks = (size + grain - 1) / grain;
+		if(chunks == 1) return f(0, size);
+
+		std::atomic<size_t> remaining = chunks - 1;
+		for(size_t chunk = 1; chunk < chunks; ++chunk)
+			pool.submit([&f, &remaining, chunk, grain, size] {
+				f(chunk * grain, std::min(size, (chunk + 1) * grain));
+				remaining.fetch_sub(1, std::memory_order_release);
+			});
+		f(0, grain);
+		pool.help_until([&remaining] { return remaining.load(std::memory_order_acquire) == 0; });
+	}
+
+	// Sorts size elements by sorting a run on each thread then merging neighbouring runs (every round of merges is also spread across the pool)
+	//  scratch must have room for size elements, anything no bigger than a single run is sorted on the calling thread
+	//  A grain of zero picks a run size which gives each thread one run
+	template<typename T, typename Compare>
+	void sort(T* data, size_t size, const Compare& comparator, T* scratch, size_t grain = 0, ThreadPool& pool = ThreadPool::global()) {
+		if(grain == 0) grain = std::max<size_t>((size + pool.thread_count() - 1) / pool.thread_count(), 16 * 1024);
+		if(size <= grain) return std::sort(data, data + size, comparator);
+		for_each_chunk(size, [&](size_t begin, size_t end) {
+			std::sort(data + begin, data + end, comparator);
+		}, grain, pool);
+
+		T* from = data, *to = scratch;
+		for(size_t width = grain; width < size; width *= 2, std::swap(from, to))
+			for_each_chunk((size + 2 * width - 1) / (2 * width), [&](size_t first, size_t last) {
+				for(size_t pair = first; pair < last; ++pair) {
+					size_t begin = pair * 2 * width, middle = std::min(begin + width, size), end = std::min(begin + 2 * width, size);
+					std::merge(from + begin, from + middle, from + middle, from + end, to + begin, comparator);
+				}
+			}, 1, pool);
+		if(from != data) std::copy(from, from + size, data);
+	}
+
+	// Sorts the storage like Storage::sort (comparator is f(T*, T*) or f(T*, entity_t, T*, entity_t)) with the comparisons spread across the pool
+	template<typename T, size_t Unique = 0, typename F>
+	void sort(TrivialModule& module, const F& _comparator, size_t grain = 0, ThreadPool& pool = ThreadPool::global()) {
+		auto sorter = [grain, &pool](size_t* order, size_t size, const auto& comparator, ScratchArena& arena) {
+			parallel::sort(order, size, comparator, ECRS_SCRATCH(arena, size_t, size), grain, pool);
+		};
+		Storage& storage = module.get_storage<T, Unique>();
+		if constexpr(std::is_invocable_v<const F&, T*, entity_t, T*, entity_t>) {
+			auto comparator = [&_comparator](void* a, entity_t aE, void* b, entity_t bE) {
+				return _comparator((T*)a, aE, (T*)b, bE);
+			};
+			sort_impl<T, decltype(comparator), true, Unique>(&storage, module, comparator, {}, sorter);
+		} else {
+			auto comparator = [&_comparator](void* a, void* b) {
+				return _comparator((T*)a, (T*)b);
+			};
+			sort_impl<T, decltype(comparator), false, Unique>(&storage, module, comparator, {}, sorter);
+		}
+	}
+
+	// Scratch memory for the storages this thread sorts on behalf of make_all_monotonic (kept between calls, freed when the thread exits)
+	inline ScratchArena& thread_scratch() {
+		thread_local struct Holder {
+			ScratchArena arena;
+			~Holder() { arena.free(); }
+		} holder;
+		return holder.arena;
+	}
+
+	// Makes every initialized (and ungrouped) storage monotonic like TrivialModule::make_all_monotonic, sorting different storages on different threads
+	//  Each storage only rewrites its own column of entity_component_indices so they can't conflict, the largest storages are started first
+	inline void make_all_monotonic(TrivialModule& module, ThreadPool& pool = ThreadPool::global()) {
+		size_t count = fpda_size(module.storages);
+		if(count == 0) return;
+		ScratchArena& arena = module.scratch_arena();
+		ScratchArena::Scope scope(arena);
+		size_t* ids = ECRS_SCRATCH(arena, size_t, count);
+		size_t eligible = 0;
+		for(size_t id = 0; id < count; ++id) {
+			auto& storage = module.storages[id];
+			if(storage.element_size == Storage::invalid) continue; // Only initialized storages can be made monotonic
+			if(storage.group != Storage::invalid) continue; // Grouped storages have an order they need to maintain
+			ids[eligible++] = id;
+		}
+		std::sort(ids, ids + eligible, [&module](size_t a, size_t b) {
+			return module.storages[a].size() > module.storages[b].size();
+		});
+
+		for_each_chunk(eligible, [&](size_t begin, size_t end) {
+			ScratchArena::Override scratch(thread_scratch());
+			for(size_t i = begin; i < end; ++i)
+				module.storages[ids[i]].sort_monotonic(module, ids[i]);
+		}, 1, pool);
+	}
+
+	// Calls f(component) or f(entity, component) for every element of the storage in parallel
+	template<typename T, size_t Unique, typename F>
+	void for_each(TrivialModule& module, typed::Storage<T, Unique>& storage, const F& f, size_t grain = 0, ThreadPool& pool = ThreadPool::global()) {
+		StructuralLock lock(module);
+		T* data = storage.chunked() ? nullptr : storage.data();
+		for_each_chunk(storage.size(), [&](size_t begin, size_t end) {
+			for(size_t i = begin; i < end; ++i) {
+				T& value = data ? data[i] : storage.get(i);
+				if constexpr(std::is_invocable_v<const F&, entity_t, T&>)
+					f(storage.entities[i], value);
+				else f(value);
+			}
+		}, grain, pool);
+	}
+	template<typename T, size_t Unique = 0, typename F>
+	void for_each(TrivialModule& module, const F& f, size_t grain = 0, ThreadPool& pool = ThreadPool::global()) {
+		static_assert(!is_tag_v<T>, "Tags don't have storages to iterate, use a query instead");
+		auto& storage = *(typed::Storage<T, Unique>*)&module.get_storage<T, Unique>();
+		for_each(module, storage, f, grain, pool);
+	}
+
+	// Calls f with the results of every entity matching the query in parallel
+	template<typename... Terms, typename F>
+	void for_each(const Query<Terms...>& query, const F& f, size_t grain = 0, ThreadPool& pool = ThreadPool::global()) {
+		StructuralLock lock(*query.module);
+		for_each_chunk(query.size(), [&](size_t begin, size_t end) {
+			query.each(begin, end, f);
+		}, grain, pool);
+	}
+}
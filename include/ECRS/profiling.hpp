@@ -0,0 +1,56 @@
+#pragma once
+
+// Instrumentation for the library's hot paths, everything compiles to nothing unless ECRS_ENABLE_PROFILING is defined
+//  Zones go to Tracy when it is available (define ECRS_ZONE_SCOPED_NAMED before including ECRS to route them elsewhere)
+//  Counters are process wide relaxed atomics, read them with ecrs::profiling::count
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ecrs::profiling {
+
+	enum class Counter : uint8_t {
+		ComponentAdds,
+		ComponentRemoves,
+		Swaps,
+		Reorders,
+		Sorts,
+		Rehashes,
+		Serializations,
+		Deserializations,
+		Unifications,
+		GoalSteps, // Relational goals (has_component, related_entities, etc...) run against a state
+		Count,
+	};
+
+	namespace detail {
+		inline std::array<std::atomic<size_t>, size_t(Counter::Count)> counters = {};
+	}
+
+	// Number of times the counter has been hit since the last reset (always zero when profiling is disabled)
+	inline size_t count(Counter counter) noexcept {
+		return detail::counters[size_t(counter)].load(std::memory_order_relaxed);
+	}
+	inline void reset() noexcept {
+		for(auto& counter: detail::counters)
+			counter.store(0, std::memory_order_relaxed);
+	}
+}
+
+#ifdef ECRS_ENABLE_PROFILING
+	#ifndef ECRS_ZONE_SCOPED_NAMED
+		#if __has_include(<tracy/Tracy.hpp>)
+			#include <tracy/Tracy.hpp>
+			#define ECRS_ZONE_SCOPED_NAMED(name) ZoneScopedN(name)
+		#else
+			#define ECRS_ZONE_SCOPED_NAMED(name) (void)0
+		#endif
+	#endif
+	#define ECRS_COUNT(counter) ecrs::profiling::detail::counters[size_t(ecrs::profiling::Counter::counter)].fetch_add(1, std::memory_order_relaxed)
+#else
+	#undef ECRS_ZONE_SCOPED_NAMED
+	#define ECRS_ZONE_SCOPED_NAMED(name) (void)0
+	#define ECRS_COUNT(counter) (void)0
+#endif
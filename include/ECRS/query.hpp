@@ -0,0 +1,248 @@
+#pragma once
+
+#include "ecs.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <tuple>
+
+namespace ecrs {
+
+	// Query term which yields the entity currently being visited
+	struct include_entity {};
+	// Query term which only matches entities which do NOT have T
+	template<typename T, size_t Unique = 0>
+	struct exclude {};
+	// NOTE: std::optional<T> query terms match every entity and yield a T* which is nullptr if the entity doesn't have T
+	// Query term which only matches entities whose T was added after the query's since tick (T's storage must be tracked, see TrivialModule::track_changes)
+	template<typename T, size_t Unique = 0>
+	struct added {};
+	// Query term which only matches entities whose T was added or marked changed after the query's since tick
+	template<typename T, size_t Unique = 0>
+	struct changed {};
+
+	namespace detail {
+		inline Storage* find_initialized_storage(TrivialModule& module, component_t id) noexcept {
+			if(fpda_size(module.storages) <= id || module.storages[id].element_size == Storage::invalid) return nullptr;
+			return module.storages + id;
+		}
+		inline bool row_has(const index_t* row, size_t row_size, component_t id) noexcept {
+			return row_size > id && row[id] != Storage::invalid_index;
+		}
+
+		// NOTE: Terms also provide word(w), a mask of which entities in [64 * w, 64 * w + 64) they could possibly accept (used to skip 64 entities at a time when there is no storage to drive iteration)
+		constexpr uint64_t all_bits = ~uint64_t(0);
+
+		// Required component, yields a T&
+		template<typename T, size_t Unique = 0>
+		struct query_term {
+			using result = std::tuple<T&>;
+			component_t id;
+			Storage* storage;
+			const TrivialModule* module;
+
+			inline void initialize(TrivialModule& module, size_t since) noexcept {
+				id = get_global_component_id<T, Unique>();
+				this->module = &module;
+				if constexpr(!is_tag_v<T>) storage = find_initialized_storage(module, id);
+			}
+			// Number of entities this term could possibly match (Storage::invalid if it can't drive iteration)
+			inline size_t candidates() const noexcept {
+				if constexpr(is_tag_v<T>) return Storage::invalid; // Tags don't have a storage to iterate
+				else return storage ? storage->size() : 0;
+			}
+			inline Storage* driver() const noexcept {
+				if constexpr(is_tag_v<T>) return nullptr;
+				else return storage;
+			}
+			inline bool accept(entity_t e, const index_t* row, size_t row_size) const noexcept {
+				if constexpr(is_tag_v<T>) return module->has_tag(e, id);
+				else return row_has(row, row_size, id);
+			}
+			inline uint64_t word(size_t w) const noexcept {
+				if constexpr(is_tag_v<T>) return module->tag_word(id, w);
+				else return all_bits;
+			}
+			inline result fetch(entity_t e, const index_t* row, size_t row_size) const noexcept {
+				if constexpr(is_tag_v<T>) return {detail::tag_value<T>()};
+				else return {storage->get<T>(row[id])};
+			}
+		};
+
+		// Optional component, yields a T* (nullptr if missing)
+		template<typename T, size_t Unique>
+		struct query_term<std::optional<T>, Unique> {
+			using result = std::tuple<T*>;
+			query_term<T, Unique> inner;
+
+			inline void initialize(TrivialModule& module, size_t since) noexcept { inner.initialize(module, since); }
+			inline size_t candidates() const noexcept { return Storage::invalid; }
+			inline Storage* driver() const noexcept { return nullptr; }
+			inline bool accept(entity_t e, const index_t* row, size_t row_size) const noexcept { return true; }
+			inline uint64_t word(size_t w) const noexcept { return all_bits; }
+			inline result fetch(entity_t e, const index_t* row, size_t row_size) const noexcept {
+				if(!inner.accept(e, row, row_size)) return {nullptr};
+				return {&std::get<0>(inner.fetch(e, row, row_size))};
+			}
+		};
+
+		// Excluded component, yields nothing
+		template<typename T, size_t Unique, size_t Ignored>
+		struct query_term<exclude<T, Unique>, Ignored> {
+			using result = std::tuple<>;
+			query_term<T, Unique> inner;
+
+			inline void initialize(TrivialModule& module, size_t since) noexcept { inner.initialize(module, since); }
+			inline size_t candidates() const noexcept { return Storage::invalid; }
+			inline Storage* driver() const noexcept { return nullptr; }
+			inline bool accept(entity_t e, const index_t* row, size_t row_size) const noexcept { return !inner.accept(e, row, row_size); }
+			inline uint64_t word(size_t w) const noexcept {
+				if constexpr(is_tag_v<T>) return ~inner.word(w);
+				else return all_bits;
+			}
+			inline result fetch(entity_t e, const index_t* row, size_t row_size) const noexcept { return {}; }
+		};
+
+		// Added or changed component, yields nothing (pair it with T to access the component)
+		template<typename T, size_t Unique, bool OnlyAdded>
+		struct tick_query_term {
+			static_assert(!is_tag_v<T>, "Tags don't have storages to track");
+			using result = std::tuple<>;
+			query_term<T, Unique> inner;
+			size_t since;
+
+			inline void initialize(TrivialModule& module, size_t since) noexcept {
+				inner.initialize(module, since);
+				this->since = since;
+				assert(!inner.storage || inner.storage->tracked());
+			}
+			inline size_t candidates() const noexcept { return inner.candidates(); }
+			inline Storage* driver() const noexcept { return inner.driver(); }
+			inline bool accept(entity_t e, const index_t* row, size_t row_size) const noexcept {
+				if(!inner.accept(e, row, row_size)) return false;
+				if constexpr(OnlyAdded) return inner.storage->added_since(row[inner.id], since);
+				else return inner.storage->changed_since(row[inner.id], since);
+			}
+			inline uint64_t word(size_t w) const noexcept { return all_bits; }
+			inline result fetch(entity_t e, const index_t* row, size_t row_size) const noexcept { return {}; }
+		};
+		template<typename T, size_t Unique, size_t Ignored>
+		struct query_term<added<T, Unique>, Ignored> : public tick_query_term<T, Unique, true> {};
+		template<typename T, size_t Unique, size_t Ignored>
+		struct query_term<changed<T, Unique>, Ignored> : public tick_query_term<T, Unique, false> {};
+
+		// The current entity
+		template<size_t Ignored>
+		struct query_term<include_entity, Ignored> {
+			using result = std::tuple<entity_t>;
+
+			inline void initialize(TrivialModule& module, size_t since) noexcept {}
+			inline size_t candidates() const noexcept { return Storage::invalid; }
+			inline Storage* driver() const noexcept { return nullptr; }
+			inline bool accept(entity_t e, const index_t* row, size_t row_size) const noexcept { return true; }
+			inline uint64_t word(size_t w) const noexcept { return all_bits; }
+			inline result fetch(entity_t e, const index_t* row, size_t row_size) const noexcept { return {e}; }
+		};
+	}
+
+	// Visits every entity matching all of Terms, iteration is driven by the smallest storage among the required terms
+	//  (if no term has a storage to drive iteration every entity is visited instead)
+	template<typename... Terms>
+	struct Query {
+		using result = decltype(std::tuple_cat(std::declval<typename detail::query_term<Terms>::result>()...));
+
+		TrivialModule* module;
+		std::tuple<detail::query_term<Terms>...> terms;
+		Storage* driver = nullptr;
+
+		// NOTE: since only affects added and changed terms
+		Query(TrivialModule& module, size_t since = 0) : module(&module) {
+			size_t smallest = Storage::invalid;
+			std::apply([&](auto&... term) {
+				(term.initialize(module, since), ...);
+				([&] {
+					if(size_t candidates = term.candidates(); candidates < smallest) {
+						smallest = candidates;
+						driver = term.driver();
+					}
+				}(), ...);
+			}, terms);
+			empty = smallest == 0;
+		}
+
+		// Number of slots (storage elements or entities) iteration walks over
+		inline size_t size() const noexcept {
+			if(empty) return 0;
+			return driver ? driver->size() : module->entity_count();
+		}
+
+		// Entity visited by the given slot
+		inline entity_t entity(size_t slot) const noexcept {
+			return driver ? driver->entities[slot] : entity_t(slot);
+		}
+
+		// Checks if the entity matches every term
+		inline bool matches(entity_t e) const noexcept {
+			if(e == invalid_entity || e >= module->entity_count()) return false;
+			const index_t* row = module->entity_component_indices[e];
+			size_t row_size = fpda_size(module->entity_component_indices[e]);
+			if(!driver && (e == 0 || module->is_released(e))) return false; // Entity zero is never handed out
+			return std::apply([&](const auto&... term) { return (term.accept(e, row, row_size) && ...); }, terms);
+		}
+
+		inline result fetch(entity_t e) const noexcept {
+			const index_t* row = module->entity_component_indices[e];
+			size_t row_size = fpda_size(module->entity_component_indices[e]);
+			return std::apply([&](const auto&... term) { return std::tuple_cat(term.fetch(e, row, row_size)...); }, terms);
+		}
+
+		// Calls f with the results of every matching entity in slots [begin, end)
+		template<typename F>
+		inline void each(size_t begin, size_t end, const F& f) const {
+			if(!driver) return each_entity(begin, end, f);
+			for(size_t slot = begin; slot < end; ++slot) {
+				entity_t e = entity(slot);
+				if(!matches(e)) continue;
+				std::apply(f, fetch(e));
+			}
+		}
+		template<typename F>
+		inline void each(const F& f) const { each(0, size(), f); }
+
+		struct iterator {
+			const Query* query;
+			size_t slot;
+
+			inline void skip_unmatched() {
+				for(size_t size = query->size(); slot < size && !query->matches(query->entity(slot)); ++slot);
+			}
+			inline result operator*() const { return query->fetch(query->entity(slot)); }
+			inline iterator& operator++() { ++slot; skip_unmatched(); return *this; }
+			inline bool operator==(const iterator& other) const { return slot == other.slot; }
+		};
+		inline iterator begin() const { iterator out{this, 0}; out.skip_unmatched(); return out; }
+		inline iterator end() const { return {this, size()}; }
+
+	protected:
+		bool empty = false; // True when a required term has no elements (nothing can match)
+
+		// Without a driving storage every entity is a slot, the terms' masks (ie tag bitsets) are combined to skip 64 entities at a time
+		template<typename F>
+		inline void each_entity(size_t begin, size_t end, const F& f) const {
+			for(size_t w = begin / 64, words = (end + 63) / 64; w < words; ++w) {
+				uint64_t mask = std::apply([w](const auto&... term) { return (detail::all_bits & ... & term.word(w)); }, terms);
+				if(w == begin / 64) mask &= detail::all_bits << (begin % 64);
+				if(w == (end - 1) / 64 && end % 64) mask &= detail::all_bits >> (64 - end % 64);
+				while(mask) {
+					entity_t e = w * 64 + std::countr_zero(mask);
+					mask &= mask - 1;
+					if(!matches(e)) continue;
+					std::apply(f, fetch(e));
+				}
+			}
+		}
+	};
+
+	template<typename... Terms>
+	inline Query<Terms...> query(TrivialModule& module, size_t since = 0) { return {module, since}; }
+}
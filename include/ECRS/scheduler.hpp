@@ -0,0 +1,178 @@
+#pragma once
+
+#include "parallel.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace ecrs {
+
+	// Declares the components a system reads
+	template<typename... Ts>
+	struct reads {};
+	// Declares the components a system writes
+	template<typename... Ts>
+	struct writes {};
+	// Declares that a system makes structural changes (creates/releases entities, adds/removes components) and thus must run alone
+	struct exclusive {};
+
+	struct Scheduler {
+		using clock = std::chrono::steady_clock;
+		static constexpr size_t invalid = std::numeric_limits<size_t>::max();
+
+		struct System {
+			std::string name;
+			std::function<void(TrivialModule&)> function;
+			fp_dynarray(component_t) reads = nullptr;
+			fp_dynarray(component_t) writes = nullptr;
+			bool exclusive = false;
+			fp_dynarray(size_t) dependents = nullptr; // Systems which must wait for this one to finish
+			size_t dependency_count = 0;
+			clock::duration duration = {}; // How long the system took during the last run
+
+			System() = default;
+			System(const System&) = delete; // Owns its access and dependent lists
+			System(System&& o) noexcept { *this = std::move(o); }
+			System& operator=(const System&) = delete;
+			System& operator=(System&& o) noexcept {
+				free();
+				name = std::move(o.name);
+				function = std::move(o.function);
+				reads = std::exchange(o.reads, nullptr);
+				writes = std::exchange(o.writes, nullptr);
+				exclusive = o.exclusive;
+				dependents = std::exchange(o.dependents, nullptr);
+				dependency_count = o.dependency_count;
+				duration = o.duration;
+				return *this;
+			}
+			~System() { free(); }
+
+			inline void free() {
+				if(reads) fpda_free_and_null(reads);
+				if(writes) fpda_free_and_null(writes);
+				if(dependents) fpda_free_and_null(dependents);
+			}
+		};
+
+		std::vector<System> systems; // In registration order, systems only ever depend on systems registered before them
+		clock::duration last_run_duration = {};
+
+		Scheduler() = default;
+		Scheduler(const Scheduler&) = delete;
+		Scheduler(Scheduler&&) = default;
+		Scheduler& operator=(const Scheduler&) = delete;
+		Scheduler& operator=(Scheduler&&) = default; // NOTE: Systems free their own lists, so the replaced systems don't leak
+
+		// Adds a system (called as f(module)), Access is any number of reads<...>, writes<...>, or exclusive
+		//  The system will run after every previously added system it conflicts with (one writes something the other reads or writes)
+		template<typename... Access, typename F>
+		size_t add_system(std::string_view name, F&& f) {
+			System system;
+			system.name = name;
+			system.function = std::forward<F>(f);
+			(AccessOp<Access>{}(system), ...);
+
+			size_t index = systems.size();
+			for(size_t i = 0; i < index; ++i)
+				if(conflicts(systems[i], system)) {
+					fpda_push_back(systems[i].dependents, index);
+					++system.dependency_count;
+				}
+			systems.push_back(std::move(system));
+			return index;
+		}
+
+		size_t find(std::string_view name) const noexcept {
+			for(size_t i = 0; i < systems.size(); ++i)
+				if(systems[i].name == name) return i;
+			return invalid;
+		}
+
+		// Runs every system once, systems which don't conflict run concurrently on the pool
+		void run(TrivialModule& module, parallel::ThreadPool& pool = parallel::ThreadPool::global()) {
+			size_t count = systems.size();
+			if(count == 0) return;
+
+			auto waiting = std::make_unique<std::atomic<size_t>[]>(count);
+			for(size_t i = 0; i < count; ++i)
+				waiting[i].store(systems[i].dependency_count, std::memory_order_relaxed);
+			std::atomic<size_t> remaining = count;
+
+			auto start = clock::now();
+			auto execute = [&](size_t index, const auto& execute) -> void {
+				auto& system = systems[index];
+				auto begin = clock::now();
+				system.function(module);
+				system.duration = clock::now() - begin;
+
+				fp_iterate_named(system.dependents, dependent)
+					if(waiting[*dependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+						pool.submit([&execute, dependent = *dependent] { execute(dependent, execute); });
+				remaining.fetch_sub(1, std::memory_order_release);
+			};
+			for(size_t i = 0; i < count; ++i)
+				if(systems[i].dependency_count == 0)
+					pool.submit([&execute, i] { execute(i, execute); });
+			pool.help_until([&remaining] { return remaining.load(std::memory_order_acquire) == 0; });
+			last_run_duration = clock::now() - start;
+		}
+
+		// The chain of dependent systems with the largest total duration during the last run (no run can finish faster than it)
+		std::vector<size_t> critical_path(clock::duration* total = nullptr) const {
+			size_t count = systems.size();
+			std::vector<clock::duration> start(count, clock::duration::zero()); // Latest finish among each system's dependencies
+			std::vector<size_t> previous(count, invalid);
+			clock::duration longest = {};
+			size_t last = invalid;
+			for(size_t i = 0; i < count; ++i) {
+				auto finish = start[i] + systems[i].duration;
+				if(last == invalid || finish > longest) {
+					longest = finish;
+					last = i;
+				}
+				fp_iterate_named(systems[i].dependents, dependent)
+					if(previous[*dependent] == invalid || finish > start[*dependent]) {
+						start[*dependent] = finish;
+						previous[*dependent] = i;
+					}
+			}
+
+			std::vector<size_t> path;
+			for(size_t i = last; i != invalid; i = previous[i])
+				path.push_back(i);
+			std::reverse(path.begin(), path.end());
+			if(total) *total = longest;
+			return path;
+		}
+
+	protected:
+		template<typename T>
+		struct AccessOp;
+		template<typename... Ts>
+		struct AccessOp<ecrs::reads<Ts...>> {
+			inline void operator()(System& system) const { (fpda_push_back(system.reads, get_global_component_id<Ts>()), ...); }
+		};
+		template<typename... Ts>
+		struct AccessOp<ecrs::writes<Ts...>> {
+			inline void operator()(System& system) const { (fpda_push_back(system.writes, get_global_component_id<Ts>()), ...); }
+		};
+		template<typename Ignored>
+		requires(std::is_same_v<Ignored, ecrs::exclusive>)
+		struct AccessOp<Ignored> {
+			inline void operator()(System& system) const { system.exclusive = true; }
+		};
+
+		static bool overlaps(const fp_dynarray(component_t) a, const fp_dynarray(component_t) b) noexcept {
+			for(size_t i = 0, aSize = fpda_size(a); i < aSize; ++i)
+				for(size_t j = 0, bSize = fpda_size(b); j < bSize; ++j)
+					if(a[i] == b[j]) return true;
+			return false;
+		}
+		static bool conflicts(const System& a, const System& b) noexcept {
+			if(a.exclusive || b.exclusive) return true;
+			return overlaps(a.writes, b.writes) || overlaps(a.writes, b.reads) || overlaps(a.reads, b.writes);
+		}
+	};
+}
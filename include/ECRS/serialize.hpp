@@ -70,6 +70,8 @@ namespace ecrs::serialize {
 	// component data[component_count];
 	template<std::integral Tuint, typename Tcomponent, size_t Unique = 0>
 	fp::dynarray<std::byte> serialize(const TrivialModule& module) {
+		ECRS_ZONE_SCOPED_NAMED("ecrs::serialize::component");
+		ECRS_COUNT(Serializations);
 		constexpr static component_info<Tcomponent> info;
 		fp::array<std::byte, sizeof(Tuint)> number_source;
 		auto& storage = module.get_storage<Tcomponent, Unique>();
@@ -89,6 +91,8 @@ namespace ecrs::serialize {
 
 	template<std::integral Tuint, typename Tcomponent, size_t Unique = 0>
 	size_t deserialize(TrivialModule& module, fp::view<std::byte> bytes) {
+		ECRS_ZONE_SCOPED_NAMED("ecrs::deserialize::component");
+		ECRS_COUNT(Deserializations);
 		constexpr static component_info<Tcomponent> info;
 		size_t offset = 0;
 		Tuint count = *(Tuint*)(bytes.data() + offset); assert_with_side_effects((offset += sizeof(Tuint)) <= bytes.size());
@@ -125,6 +129,10 @@ namespace ecrs::serialize {
 
 		*(Tuint*)out.data() = sizeof...(Tcomponents);
 		constexpr static auto op = []<typename Tcomponent>(const TrivialModule& module, fp::dynarray<std::byte>& out) {
+			if constexpr(is_tag_v<Tcomponent>) { // Tags are part of the entity data, they only get an empty header
+				out.grow(2 * sizeof(Tuint), std::byte{0});
+				return;
+			}
 			fp::raii::dynarray<std::byte> tmp = serialize<Tuint, Tcomponent>(module);
 			out.concatenate_in_place(tmp.raw);
 		};
@@ -139,6 +147,10 @@ namespace ecrs::serialize {
 		assert(component_type_count == sizeof...(Tcomponents));
 
 		constexpr auto apply_component = []<typename Tcomponent>(const fp::view<std::byte>& bytes, size_t& offset, TrivialModule& module) {
+			if constexpr(is_tag_v<Tcomponent>) {
+				assert_with_side_effects((offset += 2 * sizeof(Tuint)) <= bytes.size());
+				return;
+			}
 			size_t consumed = deserialize<Tuint, Tcomponent>(module, bytes.subview(offset));
 			assert_with_side_effects((offset += consumed) <= bytes.size());
 		};
@@ -148,17 +160,18 @@ namespace ecrs::serialize {
 
 
 
-	inline static void apply_component_id_map(fp::dynarray<size_t>& out, const fp::dynarray<size_t> entity_component_indices, const fp::view<size_t> component_id_map) {
+	// NOTE: Mapped indices are always size_t (with -1 marking missing components) so the serialized format doesn't depend on index_t
+	inline static void apply_component_id_map(fp::dynarray<size_t>& out, const fp::dynarray<index_t> entity_component_indices, const fp::view<size_t> component_id_map) {
 		out.resize(component_id_map.size());
 		for(size_t i = 0; i < component_id_map.size(); ++i)
-			if(entity_component_indices.size() <= component_id_map[i])
+			if(entity_component_indices.size() <= component_id_map[i] || entity_component_indices[component_id_map[i]] == Storage::invalid_index)
 				out[i] = -1;
 			else out[i] = entity_component_indices[component_id_map[i]];
 	}
-	inline static fp::dynarray<size_t> apply_component_id_map(const fp::dynarray<size_t> entity_component_indices, const fp::view<size_t> component_id_map) {
+	inline static fp::dynarray<size_t> apply_component_id_map(const fp::dynarray<index_t> entity_component_indices, const fp::view<size_t> component_id_map) {
 		fp::dynarray<size_t> out; apply_component_id_map(out, entity_component_indices, component_id_map); return out;
 	}
-	inline static void unapply_component_id_map(fp::dynarray<size_t>& entity_component_indices, const fp::view<size_t> mapped_entity_component_indices, const fp::view<size_t> component_id_map) {
+	inline static void unapply_component_id_map(fp::dynarray<index_t>& entity_component_indices, const fp::view<size_t> mapped_entity_component_indices, const fp::view<size_t> component_id_map) {
 		for(size_t i = 0; i < component_id_map.size(); ++i) {
 			size_t unmapped = component_id_map[i];
 			if(entity_component_indices.size() <= unmapped)
@@ -170,7 +183,7 @@ namespace ecrs::serialize {
 	inline static fp::view<size_t> full_map(const TrivialModule& module) {
 		thread_local static fp::raii::dynarray<size_t> full_map{nullptr};
 		full_map.free_and_null();
-		full_map.resize(fpda_size(module.storages));
+		full_map.resize(std::max(fpda_size(module.storages), fpda_size(module.tags)));
 		for(size_t i = 0; i < full_map.size(); ++i)
 			full_map[i] = i; // Map to itself
 		return full_map.view_full();
@@ -180,8 +193,10 @@ namespace ecrs::serialize {
 	// Tuint component_id_map_size;
 	// Tuint component_id_map[component_id_map_size];
 	// Tuint entity_component_indices[entity_count][component_id_map_size];
+	// uint32_t entity_versions[entity_count];
 	template<std::integral Tuint, typename... Tcomponents>
 	fp::dynarray<std::byte> serialize_entity_data(const TrivialModule& module, std::optional<fp::view<size_t>> component_id_map = {}) {
+		ECRS_ZONE_SCOPED_NAMED("ecrs::serialize::entities");
 		constexpr static auto concat_size_t_view = [](fp::dynarray<std::byte>& out, const fp::view<size_t> view) {
 			if constexpr(sizeof(size_t) == sizeof(Tuint)) {
 				out.concatenate_view_in_place(view.byte_view());
@@ -206,12 +221,22 @@ namespace ecrs::serialize {
 		fp::raii::dynarray<size_t> mapped{nullptr};
 		for(entity_t e = 0; e < module.entity_count(); ++e) {
 			apply_component_id_map((fp::dynarray<size_t>&)mapped, module.entity_component_indices[e], *component_id_map);
+			for(size_t i = 0; i < component_id_map->size(); ++i) // Tags live in bitsets, store them as present (true) in the entity data
+				if(module.is_tag((*component_id_map)[i]))
+					mapped[i] = module.has_tag(e, (*component_id_map)[i]) ? true : size_t(-1);
 			concat_size_t_view(out, mapped.full_view());
 		}
+
+		// NOTE: Versions are always 32 bits, truncating them could let stale handles validate again
+		size_t versions = out.size();
+		out.grow(module.entity_count() * sizeof(uint32_t));
+		std::memcpy(out.data() + versions, module.entity_versions, module.entity_count() * sizeof(uint32_t));
 		return out;
 	}
 	template<std::integral Tuint>
 	std::pair<size_t, fp::dynarray<size_t>> deserialize_entity_data(TrivialModule& module, const fp::view<std::byte> bytes) {
+		ECRS_ZONE_SCOPED_NAMED("ecrs::deserialize::entities");
+		ECRS_ALLOCATION_SCOPE(module.allocator);
 		size_t offset = 0;
 		Tuint entity_count = *(Tuint*)(bytes.data() + offset); assert_with_side_effects((offset += sizeof(Tuint)) <= bytes.size());
 		Tuint map_size = *(Tuint*)(bytes.data() + offset); assert_with_side_effects((offset += sizeof(Tuint)) <= bytes.size());
@@ -226,20 +251,40 @@ namespace ecrs::serialize {
 			}
 		} else component_id_map = fp::dynarray<size_t>{nullptr}.concatenate_view_in_place(full_map(module));
 
-		auto entity_component_indices = fp::dynarray<fp::dynarray<size_t>>{(fp::dynarray<size_t>*)module.entity_component_indices};
+		auto entity_component_indices = fp::dynarray<fp::dynarray<index_t>>{(fp::dynarray<index_t>*)module.entity_component_indices};
 		if(entity_component_indices.size() < entity_count) entity_component_indices.grow_to_size(entity_count, nullptr);
+		if(fpda_size(module.entity_versions) < entity_count) {
+			bool seed = fpda_size(module.entity_versions) == 0;
+			fpda_grow_to_size_and_initialize(module.entity_versions, entity_count, 0);
+			if(seed) module.entity_versions[0] = 1; // Entity zero starts at version one so that invalid_handle never validates
+		}
 		auto tmp = fp::raii::dynarray<size_t>{nullptr}.resize(map_size);
 		for (size_t e = 0; e < entity_count; ++e) {
 			if constexpr(sizeof(Tuint) == sizeof(size_t)) {
 				std::memcpy(tmp.raw, bytes.data() + offset, sizeof(size_t) * map_size); assert_with_side_effects((offset += sizeof(size_t) * map_size) <= bytes.size());
 			} else for (size_t i = 0; i < map_size; ++i) {
-				tmp[i] = *(Tuint*)(bytes.data() + offset); assert_with_side_effects((offset += sizeof(Tuint)) <= bytes.size());
+				Tuint index = *(Tuint*)(bytes.data() + offset); assert_with_side_effects((offset += sizeof(Tuint)) <= bytes.size());
+				tmp[i] = index == Tuint(-1) ? size_t(-1) : size_t(index); // Narrow formats still mark missing components with all bits set
 			}
 			if(!entity_component_indices[e].is_dynarray() && entity_component_indices[e].raw != nullptr) 
 				entity_component_indices.free_and_null();
 			unapply_component_id_map(entity_component_indices[e], tmp.full_view(), component_id_map.full_view());
+			for(size_t i = 0; i < component_id_map.size(); ++i) // Move known tags back into their bitsets
+				if(size_t id = component_id_map[i]; module.is_tag(id) && entity_component_indices[e].size() > id && entity_component_indices[e][id] != Storage::invalid_index) {
+					entity_component_indices[e][id] = Storage::invalid_index;
+					module.set_tag(e, id);
+				}
 		}
-		module.entity_component_indices = (size_t**)entity_component_indices.raw;
+		module.entity_component_indices = (index_t**)entity_component_indices.raw;
+
+		if(entity_count > 0) {
+			std::memcpy(module.entity_versions, bytes.data() + offset, entity_count * sizeof(uint32_t)); assert_with_side_effects((offset += entity_count * sizeof(uint32_t)) <= bytes.size());
+			module.entity_versions[0] |= 1;
+		}
+		// Released entities (odd versions) come back released and ready for reuse
+		if(module.freelist) fpda_clear(module.freelist);
+		for(entity_t e = 1, size = module.entity_count(); e < size; ++e)
+			if(module.is_released(e)) fpda_push_back(module.freelist, e);
 		return {offset, component_id_map};
 	}
 
@@ -248,6 +293,7 @@ namespace ecrs::serialize {
 	template<std::integral Tuint, typename... Tcomponents>
 	requires(sizeof...(Tcomponents) > 1)
 	fp::dynarray<std::byte> serialize(const TrivialModule& module) {
+		ECRS_ZONE_SCOPED_NAMED("ecrs::serialize");
 		fp::raii::dynarray<size_t> map = make_component_id_map<Tcomponents...>();
 		auto out = serialize_entity_data<Tuint, Tcomponents...>(module, map.full_view());
 		fp::raii::dynarray<std::byte> tmp = serialize_component_data<Tuint, Tcomponents...>(module);
@@ -256,9 +302,14 @@ namespace ecrs::serialize {
 	template<std::integral Tuint, typename... Tcomponents>
 	requires(sizeof...(Tcomponents) > 1)
 	size_t deserialize(TrivialModule& module, const fp::view<std::byte> data) {
+		ECRS_ZONE_SCOPED_NAMED("ecrs::deserialize");
+		// Tags must be known before decoding the entity data, otherwise they would land in entity_component_indices instead of their bitsets
+		([&] { if constexpr(is_tag_v<Tcomponents>) module.register_tag(get_global_component_id<Tcomponents>()); }(), ...);
 		size_t offset;
 		fp::raii::dynarray<size_t> component_id_map;
 		std::tie(offset, component_id_map) = deserialize_entity_data<Tuint>(module, data);
-		return offset + deserialize_component_data<Tuint, Tcomponents...>(module, data.subview(offset));
+		offset += deserialize_component_data<Tuint, Tcomponents...>(module, data.subview(offset));
+		module.relink_all_entities();
+		return offset;
 	}
 }
\ No newline at end of file
@@ -0,0 +1,262 @@
+#pragma once
+
+#include "ecs.hpp"
+
+namespace ecrs::sparse {
+
+	// Maps entities to storage slots, pages of the map are only allocated once an entity inside of them is given a slot
+	//  NOTE: Slots are index_t (so pages hold twice as many entities with ECRS_COMPACT_INDICES), Storage::invalid_index marks entities without a slot
+	template<size_t PageSize = 4096 / sizeof(index_t)>
+	struct PagedIndex {
+		static constexpr size_t page_size = PageSize;
+		fp_dynarray(fp_dynarray(index_t)) pages = nullptr;
+
+		inline void free() noexcept {
+			if(!pages) return;
+			fpda_iterate(pages)
+				if(*i) fpda_free_and_null(*i);
+			fpda_free_and_null(pages);
+		}
+
+		inline index_t get(entity_t e) const noexcept {
+			size_t page = e / page_size;
+			if(fpda_size(pages) <= page || !pages[page]) return Storage::invalid_index;
+			return pages[page][e % page_size];
+		}
+		inline bool contains(entity_t e) const noexcept { return get(e) != Storage::invalid_index; }
+
+		inline index_t& get_or_allocate(entity_t e) noexcept {
+			size_t page = e / page_size;
+			if(fpda_size(pages) <= page)
+				fpda_grow_to_size_and_initialize(pages, page + 1, nullptr);
+			if(!pages[page])
+				fpda_grow_to_size_and_initialize(pages[page], page_size, Storage::invalid_index);
+			return pages[page][e % page_size];
+		}
+		inline void set(entity_t e, index_t index) noexcept {
+			assert(index != Storage::invalid_index);
+			get_or_allocate(e) = index;
+		}
+		inline void clear(entity_t e) noexcept {
+			size_t page = e / page_size;
+			if(fpda_size(pages) > page && pages[page])
+				pages[page][e % page_size] = Storage::invalid_index;
+		}
+
+		inline size_t allocated_pages() const noexcept {
+			size_t out = 0;
+			fpda_iterate(pages)
+				if(*i) ++out;
+			return out;
+		}
+	};
+
+	// A module which stores its entity -> slot indices as one paged sparse array per component instead of one index array per entity
+	//  (entities own no memory, so creating them never allocates and memory scales with the components actually present)
+	struct TrivialModule {
+		using Index = PagedIndex<>;
+
+		fp_dynarray(Storage) storages = nullptr;
+		fp_dynarray(Index) indices = nullptr; // Parallel to storages
+		fp_dynarray(entity_t) freelist = nullptr;
+		size_t next_entity = 0;
+
+		inline void free() {
+			if(storages) {
+				fpda_iterate(storages)
+					i->~Storage();
+				fpda_free_and_null(storages);
+			}
+			if(indices) {
+				fpda_iterate(indices)
+					i->free();
+				fpda_free_and_null(indices);
+			}
+			if(freelist) fpda_free_and_null(freelist);
+		}
+
+		size_t entity_count() const { return next_entity; }
+
+		Index& get_index(component_t componentID) noexcept {
+			if(fpda_size(indices) <= componentID) {
+				size_t old = fpda_size(indices);
+				fpda_grow_to_size(indices, componentID + 1);
+				for(size_t i = old, size = fpda_size(indices); i < size; ++i)
+					new(indices + i) Index();
+			}
+			return indices[componentID];
+		}
+
+		Storage& get_storage(component_t componentID, size_t element_size = Storage::invalid, size_t alignment = 0) noexcept {
+			if(!storages || fpda_size(storages) <= componentID) {
+				size_t old = fpda_size(storages);
+				fpda_grow_to_size(storages, componentID + 1);
+				for(size_t i = old, size = fpda_size(storages); i < size; ++i)
+					new(storages + i) Storage();
+			}
+			if(storages[componentID].element_size == Storage::invalid) {
+				assert(element_size != Storage::invalid);
+				storages[componentID] = Storage(element_size, 64, alignment);
+			}
+			return storages[componentID];
+		}
+		inline const Storage& get_storage(component_t componentID, size_t element_size = Storage::invalid) const noexcept {
+			assert(fpda_size(storages) > componentID);
+			assert(storages[componentID].element_size != Storage::invalid);
+			return storages[componentID];
+		}
+
+		template<typename T, size_t Unique = 0>
+		inline Storage& get_storage() noexcept { return get_storage(get_global_component_id<T, Unique>(), sizeof(T), storage_alignment_v<T>); }
+		template<typename T, size_t Unique = 0>
+		inline const Storage& get_storage() const noexcept { return get_storage(get_global_component_id<T, Unique>(), sizeof(T)); }
+
+		entity_t create_entity() noexcept {
+			if(!freelist || fpda_empty(freelist)) {
+				if(next_entity == 0) ++next_entity; // Skip entity zero!
+				return next_entity++;
+			}
+			return *fpda_pop_back(freelist);
+		}
+
+		bool release_entity(entity_t e, bool clearMemory = true) noexcept {
+			if(e >= next_entity) return false;
+
+			for(size_t i = 0, size = fpda_size(indices); i < size; ++i)
+				if(clearMemory) remove_component(e, i);
+				else indices[i].clear(e);
+
+			fpda_push_back(freelist, e);
+			return true;
+		}
+
+		void* add_component(entity_t e, component_t componentID, size_t element_size) noexcept {
+			ECRS_ZONE_SCOPED_NAMED("ecrs::sparse::add_component");
+			ECRS_COUNT(ComponentAdds);
+			assert(e < next_entity);
+			auto& storage = get_storage(componentID, element_size);
+			size_t index = storage.size();
+			get_index(componentID).set(e, index);
+			auto res = storage.get_or_allocate(index);
+			storage.entities[index] = e;
+			return res;
+		}
+		template<typename T, size_t Unique = 0>
+		T& add_component(entity_t e) noexcept {
+			ECRS_ZONE_SCOPED_NAMED("ecrs::sparse::add_component");
+			ECRS_COUNT(ComponentAdds);
+			assert(e < next_entity);
+			component_t componentID = get_global_component_id<T, Unique>();
+			if constexpr(is_tag_v<T>) {
+				get_index(componentID).set(e, true); // Mark the tag as present
+				return detail::tag_value<T>();
+			} else {
+				auto& storage = get_storage(componentID, sizeof(T), storage_alignment_v<T>);
+				size_t index = storage.size();
+				get_index(componentID).set(e, index);
+				auto& res = storage.template get_or_allocate<T>(index);
+				storage.entities[index] = e;
+
+				if constexpr(detail::is_with_entity_v<T>)
+					res.entity = e;
+				return res;
+			}
+		}
+
+		bool remove_component(entity_t e, component_t componentID) noexcept {
+			ECRS_ZONE_SCOPED_NAMED("ecrs::sparse::remove_component");
+			ECRS_COUNT(ComponentRemoves);
+			if(fpda_size(indices) <= componentID) return false;
+			auto& index = indices[componentID];
+			index_t slot = index.get(e);
+			if(slot == Storage::invalid_index) return false;
+			index.clear(e);
+
+			if(fpda_size(storages) <= componentID || storages[componentID].element_size == Storage::invalid)
+				return true; // Tags don't have any storage
+			auto& storage = storages[componentID];
+			if(slot >= storage.size()) return true;
+
+			// Move the last element into the removed element's slot and point its owner at the new location
+			size_t last = storage.size() - 1;
+			entity_t owner = storage.entities[last];
+			storage.swap(slot);
+			if(owner != e && owner != invalid_entity && index.get(owner) == last)
+				index.set(owner, slot);
+			storage.pop_back();
+			return true;
+		}
+		template<typename Tcomponent, size_t Unique = 0>
+		inline bool remove_component(entity_t e) noexcept {
+			return remove_component(e, get_global_component_id<Tcomponent, Unique>());
+		}
+
+		inline bool has_component(entity_t e, component_t componentID) const noexcept {
+			return fpda_size(indices) > componentID && indices[componentID].contains(e);
+		}
+		template<typename T, size_t Unique = 0>
+		inline bool has_component(entity_t e) const noexcept {
+			return has_component(e, get_global_component_id<T, Unique>());
+		}
+
+		void* get_component(entity_t e, component_t componentID) noexcept {
+			assert(has_component(e, componentID));
+			return get_storage(componentID).get(indices[componentID].get(e));
+		}
+		const void* get_component(entity_t e, component_t componentID) const noexcept {
+			assert(has_component(e, componentID));
+			return get_storage(componentID).get(indices[componentID].get(e));
+		}
+		template<typename T, size_t Unique = 0>
+		T& get_component(entity_t e) noexcept {
+			if constexpr (is_tag_v<T>) return detail::tag_value<T>();
+			else {
+				component_t componentID = get_global_component_id<T, Unique>();
+				assert(has_component(e, componentID));
+				return get_storage(componentID).template get<T>(indices[componentID].get(e));
+			}
+		}
+		template<typename T, size_t Unique = 0>
+		const T& get_component(entity_t e) const noexcept {
+			if constexpr (is_tag_v<T>) return detail::tag_value<T>();
+			else {
+				component_t componentID = get_global_component_id<T, Unique>();
+				assert(has_component(e, componentID));
+				return get_storage(componentID).template get<T>(indices[componentID].get(e));
+			}
+		}
+
+		void* get_or_add_component(entity_t e, component_t componentID, size_t element_size) noexcept {
+			if(has_component(e, componentID))
+				return get_component(e, componentID);
+			else return add_component(e, componentID, element_size);
+		}
+		template<typename T, size_t Unique = 0>
+		T& get_or_add_component(entity_t e) noexcept {
+			if(has_component<T, Unique>(e))
+				return get_component<T, Unique>(e);
+			else return add_component<T, Unique>(e);
+		}
+	};
+
+	struct Module : public TrivialModule {
+		bool should_leak = false; // Useful when shutting down, if we are closing we can just leave memory cleanup to the operating system for a bit of added performance!
+
+		Module() = default;
+		Module(const Module&) = delete; // Storages need to become copyable to change this...
+		Module(Module&& o) { *this = std::move(o); }
+		Module& operator=(const Module& o) = delete;
+		Module& operator=(Module&& o) {
+			free();
+			storages = std::exchange(o.storages, nullptr);
+			indices = std::exchange(o.indices, nullptr);
+			freelist = std::exchange(o.freelist, nullptr);
+			next_entity = std::exchange(o.next_entity, 0);
+			return *this;
+		}
+
+		~Module() {
+			if(!should_leak) free();
+		}
+	};
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "ecrs.hpp"
+
+namespace ecrs {
+
+	// Memory use of a single component
+	struct ComponentStats {
+		component_t id;
+		size_t element_size; // Zero for tags
+		size_t count; // Occupied slots (entities with the component for tags)
+		size_t capacity; // Slots which fit without growing
+		size_t bytes_reserved; // Component data plus its book keeping (slot -> entity map, change ticks, tag bitset)
+		size_t bytes_wasted; // Reserved bytes not holding an element (spare capacity and alignment slack)
+	};
+
+	// Snapshot of where a module's memory goes, reuse the same object between samples to avoid reallocating
+	//  NOTE: Sizes are what has been reserved from the allocator (dynarray headers aren't counted)
+	struct ModuleStats {
+		fp_dynarray(ComponentStats) components = nullptr; // Only components with a storage or tag bitset
+		size_t entity_count = 0; // Including released entities
+		size_t freelist_size = 0;
+		size_t index_bytes = 0; // Per entity component index arrays (and the array of them)
+		size_t index_bytes_wasted = 0; // Spare capacity of the index arrays
+		size_t relation_payload_bytes = 0; // Related entity arrays owned by dynamically sized relations (relational modules only)
+		size_t scratch_bytes = 0; // Temporary memory kept around for sorting and reordering
+		size_t total_bytes = 0; // Everything above plus freelists, entity versions, and groups
+
+		ModuleStats() = default;
+		ModuleStats(const ModuleStats&) = delete;
+		ModuleStats(ModuleStats&& o) { *this = std::move(o); }
+		ModuleStats& operator=(const ModuleStats&) = delete;
+		ModuleStats& operator=(ModuleStats&& o) {
+			free();
+			components = std::exchange(o.components, nullptr);
+			entity_count = o.entity_count;
+			freelist_size = o.freelist_size;
+			index_bytes = o.index_bytes;
+			index_bytes_wasted = o.index_bytes_wasted;
+			relation_payload_bytes = o.relation_payload_bytes;
+			scratch_bytes = o.scratch_bytes;
+			total_bytes = o.total_bytes;
+			return *this;
+		}
+		~ModuleStats() { free(); }
+
+		inline void free() {
+			if(components) fpda_free_and_null(components);
+		}
+
+		// Stats for the given component (nullptr if it has neither a storage nor a tag bitset)
+		const ComponentStats* find(component_t componentID) const noexcept {
+			fp_iterate_named(components, component)
+				if(component->id == componentID) return component;
+			return nullptr;
+		}
+		template<typename T, size_t Unique = 0>
+		inline const ComponentStats* find() const noexcept { return find(get_global_component_id<T, Unique>()); }
+	};
+
+	inline ComponentStats storage_stats(const Storage& storage, component_t componentID) noexcept {
+		ComponentStats out = {componentID, storage.element_size, storage.size()};
+		size_t bookkeeping = sizeof(entity_t) + (storage.tracked() ? 2 * sizeof(size_t) : 0); // Per slot
+		size_t bookkeeping_capacity = fpda_capacity(storage.entities);
+		if(storage.chunked()) {
+			out.capacity = storage.chunk_count() * storage.chunk_size;
+			out.bytes_reserved = out.capacity * storage.element_size + fpda_capacity(storage.chunks) * sizeof(uint8_t*);
+		} else {
+			size_t raw = fpda_capacity(storage.raw);
+			size_t slack = storage.alignment ? 2 * storage.alignment : 0;
+			out.capacity = raw > slack ? (raw - slack) / storage.element_size : 0;
+			out.bytes_reserved = raw;
+		}
+		out.bytes_reserved += bookkeeping_capacity * bookkeeping;
+		size_t used = out.count * (storage.element_size + bookkeeping);
+		out.bytes_wasted = out.bytes_reserved > used ? out.bytes_reserved - used : 0;
+		return out;
+	}
+
+	// Fills out with the module's current memory use, costs a pass over the storages and the entities (not over the elements)
+	inline void collect_stats(const TrivialModule& module, ModuleStats& out) noexcept {
+		if(out.components) fpda_clear(out.components);
+		out.entity_count = module.entity_count();
+		out.freelist_size = fpda_size(module.freelist);
+		out.index_bytes = fpda_capacity(module.entity_component_indices) * sizeof(index_t*);
+		out.index_bytes_wasted = 0;
+		out.relation_payload_bytes = 0;
+
+		fp_iterate_named(module.entity_component_indices, row) {
+			out.index_bytes += fpda_capacity(*row) * sizeof(index_t);
+			out.index_bytes_wasted += (fpda_capacity(*row) - fpda_size(*row)) * sizeof(index_t);
+		}
+
+		size_t components = std::max(fpda_size(module.storages), fpda_size(module.tags));
+		fpda_reserve(out.components, components);
+		size_t component_bytes = 0;
+		for(component_t id = 0; id < components; ++id) {
+			ComponentStats stats;
+			if(module.is_tag(id)) {
+				size_t words = fpda_capacity(module.tags[id]);
+				stats = {id, 0, module.tag_count(id), words * 64, words * sizeof(uint64_t), 0};
+				stats.bytes_wasted = stats.bytes_reserved - fpda_size(module.tags[id]) * sizeof(uint64_t);
+			} else if(fpda_size(module.storages) > id && module.storages[id].element_size != Storage::invalid)
+				stats = storage_stats(module.storages[id], id);
+			else continue;
+			component_bytes += stats.bytes_reserved;
+			fpda_push_back(out.components, stats);
+		}
+
+		out.scratch_bytes = fpda_capacity(module.scratch.blocks) * sizeof(uint8_t*);
+		fp_iterate_named(module.scratch.blocks, block)
+			out.scratch_bytes += fpda_capacity(*block);
+
+		out.total_bytes = out.index_bytes + component_bytes + out.scratch_bytes
+			+ fpda_capacity(module.storages) * sizeof(Storage)
+			+ fpda_capacity(module.tags) * sizeof(uint64_t*)
+			+ fpda_capacity(module.freelist) * sizeof(entity_t)
+			+ fpda_capacity(module.entity_versions) * sizeof(uint32_t)
+			+ fpda_capacity(module.groups) * sizeof(Group);
+		fp_iterate_named(module.groups, group)
+			out.total_bytes += fpda_capacity(group->components) * sizeof(component_t);
+	}
+	inline void collect_stats(const TrivialRelationalModule& module, ModuleStats& out) noexcept {
+		collect_stats((const TrivialModule&)module, out);
+		for(size_t id = 0, size = std::min(fpda_size(module.relation_payloads), fpda_size(module.storages)); id < size; ++id)
+			if(module.relation_payloads[id] && module.storages[id].element_size != Storage::invalid)
+				out.relation_payload_bytes += module.relation_payloads[id](module.storages[id]);
+		out.total_bytes += out.relation_payload_bytes + fpda_capacity(module.relation_payloads) * sizeof(TrivialRelationalModule::relation_payload_function);
+	}
+
+	template<std::derived_from<TrivialModule> Tmodule>
+	inline ModuleStats stats(const Tmodule& module) noexcept {
+		ModuleStats out;
+		collect_stats(module, out);
+		return out;
+	}
+}
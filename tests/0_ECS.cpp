@@ -4,6 +4,10 @@
 #define ECRS_IMPLEMENTATION
 #include <ECRS/ecrs.hpp>
 #include <ECRS/adapter.hpp>
+#include <ECRS/query.hpp>
+
+#include <algorithm>
+#include <string>
 
 #ifdef FP_ENABLE_BENCHMARKING
 	#include <nanobench.h>
@@ -101,6 +105,40 @@ TEST_SUITE("ECS") {
 		FP_FRAME_MARK;
 	}
 
+	TEST_CASE("ecrs::ManyRemovals") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::ManyRemovals", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::ManyRemovals");
+			ecrs::Module module;
+			for(size_t i = 0; i < 100; ++i) {
+				auto e = module.create_entity();
+				module.add_component<float>(e) = e;
+				if(i % 3 == 0) module.add_component<int>(e) = e;
+			}
+
+			for(ecrs::entity_t e = 1; e <= 100; e += 2)
+				CHECK(module.remove_component<float>(e) == true);
+			CHECK(module.remove_component<float>(1) == false);
+			for(ecrs::entity_t e = 4; e <= 100; e += 6)
+				CHECK(module.release_entity(e));
+
+			auto& storage = module.get_storage<float>();
+			CHECK(storage.size() == 33);
+			for(size_t i = 0; i < storage.size(); ++i) {
+				auto e = storage.get_entity(i);
+				CHECK(storage.get<float>(i) == e);
+				CHECK(module.entity_component_indices[e][ecrs::get_global_component_id<float>()] == i);
+			}
+			for(ecrs::entity_t e = 2; e <= 100; e += 2)
+				CHECK(module.has_component<float>(e) == ((e - 4) % 6 != 0));
+			// module.should_leak = true; // Don't bother cleaning up after ourselves...
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
+
 	TEST_CASE("ecrs::SortByValue") {
 #ifdef FP_ENABLE_BENCHMARKING
 		ankerl::nanobench::Bench().run("ecrs::SortByValue", []{
@@ -134,6 +172,48 @@ TEST_SUITE("ECS") {
 		FP_FRAME_MARK;
 	}
 
+	TEST_CASE("ecrs::SortNonTrivial") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::SortNonTrivial", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::SortNonTrivial");
+			ecrs::Module module;
+			std::vector<std::string> expected(1);
+			for(size_t i = 0; i < 40; ++i) { // Mixes strings stored inline with ones which are too long for the small string buffer
+				ecrs::entity_t e = module.create_entity();
+				std::string value = i % 2 ? std::to_string((i * 7) % 40) : "a string which is far too long to fit in place " + std::to_string((i * 13) % 40);
+				module.add_component<std::string>(e) = value;
+				expected.push_back(value);
+			}
+			auto& storage = module.get_storage<std::string>();
+			auto matches = [&] {
+				bool out = true;
+				for(ecrs::entity_t e = 1; e < expected.size(); ++e)
+					out &= module.get_component<std::string>(e) == expected[e];
+				return out;
+			};
+
+			storage.sort_by_value<std::string>(module);
+			CHECK(std::is_sorted(storage.data<std::string>(), storage.data<std::string>() + storage.size()));
+			CHECK(matches());
+
+			storage.sort_by_key<std::string>(module, [](const std::string& value) { return value.size(); }); // Radix sorted
+			CHECK(std::is_sorted(storage.data<std::string>(), storage.data<std::string>() + storage.size(), [](const std::string& a, const std::string& b) { return a.size() < b.size(); }));
+			CHECK(matches());
+
+			std::vector<size_t> reversed(storage.size());
+			for(size_t i = 0; i < reversed.size(); ++i) reversed[i] = reversed.size() - 1 - i;
+			std::string last = storage.get<std::string>(storage.size() - 1);
+			storage.reorder<std::string>(module, fp_view_make(size_t, reversed.data(), reversed.size()));
+			CHECK(storage.get<std::string>(0) == last);
+			CHECK(matches());
+			// module.should_leak = true; // Don't bother cleaning up after ourselves...
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
+
 	TEST_CASE("ecrs::SortMontonic") {
 #ifdef FP_ENABLE_BENCHMARKING
 		ankerl::nanobench::Bench().run("ecrs::SortMontonic", []{
@@ -168,6 +248,114 @@ TEST_SUITE("ECS") {
 		FP_FRAME_MARK;
 	}
 
+	TEST_CASE("ecrs::RadixSort") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::RadixSort", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::RadixSort");
+			struct Particle { float mass; ecrs::entity_t id; };
+			ecrs::Module module;
+			module.track_changes<int>();
+			uint64_t state = 12345;
+			auto next = [&state] { return state = state * 6364136223846793005ull + 1442695040888963407ull; };
+			ecrs::entity_t first = module.create_entities(1000);
+			for(ecrs::entity_t e = first; e < first + 1000; ++e) {
+				module.add_component<int>(e) = int(next() >> 40) - (1 << 23);
+				module.add_component<double>(e) = double(int64_t(next())) / 1e9;
+				module.add_component<Particle>(e) = {float(next() % 7) - 3, e};
+			}
+			module.advance_tick();
+			module.modify_component<int>(first + 10) += 0; // Its changed tick should follow it through the sort
+
+			auto& ints = module.get_storage<int>();
+			ints.sort_by_value<int>(module);
+			CHECK(std::is_sorted(ints.data<int>(), ints.data<int>() + ints.size()));
+			CHECK(ints.changed_since(module.entity_component_indices[first + 10][ecrs::get_global_component_id<int>()], 1));
+			for(ecrs::entity_t e = first; e < first + 1000; ++e)
+				CHECK(ints.entities[module.entity_component_indices[e][ecrs::get_global_component_id<int>()]] == e);
+
+			auto& doubles = module.get_storage<double>();
+			doubles.sort_by_value<double>(module);
+			CHECK(std::is_sorted(doubles.data<double>(), doubles.data<double>() + doubles.size()));
+			CHECK(doubles.data<double>()[0] < 0);
+
+			// Equal keys keep their relative order
+			auto& particles = module.get_storage<Particle>();
+			particles.sort_by_key<Particle>(module, [](const Particle& p) { return p.mass; });
+			Particle* data = particles.data<Particle>();
+			for(size_t i = 1; i < particles.size(); ++i) {
+				CHECK(data[i - 1].mass <= data[i].mass);
+				if(data[i - 1].mass == data[i].mass) CHECK(data[i - 1].id < data[i].id);
+				CHECK(module.get_component<Particle>(particles.entities[i]).id == particles.entities[i]);
+			}
+
+			module.make_all_monotonic();
+			for(size_t i = 1; i < particles.size(); ++i)
+				CHECK(particles.entities[i - 1] < particles.entities[i]);
+			CHECK(module.get_component<int>(first + 10) == module.get_storage<int>().data<int>()[10]);
+			// module.should_leak = true; // Don't bother cleaning up after ourselves...
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
+
+	TEST_CASE("ecrs::ScratchArena") {
+		FP_ZONE_SCOPED_NAMED("ecrs::ScratchArena");
+		ecrs::ScratchArena arena;
+		{
+			ecrs::ScratchArena::Scope outer(arena);
+			int* first = arena.allocate<int>(100);
+			first[99] = 5;
+			{
+				ecrs::ScratchArena::Scope inner(arena);
+				double* second = arena.allocate<double>(1000); // Doesn't fit, needs a second block
+				second[999] = 6;
+				CHECK(fpda_size(arena.blocks) == 2);
+			}
+			CHECK(first[99] == 5); // Earlier allocations never move
+		}
+		// Once nothing is in use the blocks are merged
+		CHECK(fpda_size(arena.blocks) == 1);
+		CHECK(fpda_size(arena.blocks[0]) >= 100 * sizeof(int) + 1000 * sizeof(double));
+		auto merged = arena.blocks[0];
+		{
+			ecrs::ScratchArena::Scope again(arena);
+			arena.allocate<double>(1000);
+		}
+		CHECK(arena.blocks[0] == merged); // Only merged again once the capacity changes
+		arena.free();
+
+		// Large sorts reuse the module's scratch memory instead of the stack
+		ecrs::Module module;
+		ecrs::entity_t first = module.create_entities(20000);
+		for(ecrs::entity_t e = first; e < first + 20000; ++e)
+			module.add_component<float>(e) = float((e * 7919) % 20000);
+		auto& storage = module.get_storage<float>();
+		storage.sort_by_value<float>(module);
+		CHECK(std::is_sorted(storage.data<float>(), storage.data<float>() + storage.size()));
+		REQUIRE(fpda_size(module.scratch.blocks) == 1);
+		auto block = module.scratch.blocks[0];
+
+		storage.sort<float>(module, [](float* a, float* b) { return *a > *b; });
+		CHECK(std::is_sorted(storage.data<float>(), storage.data<float>() + storage.size(), std::greater<float>{}));
+		module.make_all_monotonic();
+		CHECK(module.get_component<float>(first + 1) == float(((first + 1) * 7919) % 20000));
+		CHECK(fpda_size(module.scratch.blocks) == 1);
+		CHECK(module.scratch.blocks[0] == block); // Nothing was reallocated
+
+		// Module level scratch (like release_entities' marks) respects overrides too
+		ecrs::ScratchArena other;
+		{
+			ecrs::ScratchArena::Override scope(other);
+			std::vector<ecrs::entity_t> released = {first, first + 1};
+			module.release_entities(released);
+		}
+		CHECK(fpda_size(other.blocks) == 1);
+		CHECK(module.scratch.blocks[0] == block);
+		other.free();
+	}
+
 	TEST_CASE("ecrs::WithEntity") {
 #ifdef FP_ENABLE_BENCHMARKING
 		ankerl::nanobench::Bench().run("ecrs::WithEntity", []{
@@ -210,6 +398,55 @@ TEST_SUITE("ECS") {
 		FP_FRAME_MARK;
 	}
 
+	TEST_CASE("ecrs::Handle") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::Handle", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::Handle");
+			ecrs::Module module;
+			ecrs::Handle h = module.create_handle();
+			CHECK(h.index() == 1);
+			CHECK(module.valid(ecrs::invalid_handle) == false);
+			CHECK(module.valid(h));
+			module.add_component<ecrs::with_entity<float, ecrs::Handle>>(h.index()).value = 5;
+			CHECK(module.get_component<ecrs::with_entity<float, ecrs::Handle>>(h.index()).entity == h);
+			CHECK(module.valid(ecrs::Handle{1000, 0}) == false); // Indices past the last entity never validate
+
+			{ // Typed swaps and sorts read the entity back out of the handle
+				using Tracked = ecrs::with_entity<float, ecrs::Handle>;
+				ecrs::Handle other = module.create_handle();
+				module.add_component<Tracked>(other.index()).value = 3;
+				auto& storage = module.get_storage<Tracked>();
+				CHECK(storage.swap<Tracked>(module, 0, 1));
+				CHECK(module.get_component<Tracked>(h.index()).value == 5);
+				CHECK(storage.get<Tracked>(0).entity == other);
+
+				auto descending = [](Tracked* a, ecrs::entity_t, Tracked* b, ecrs::entity_t) { return a->value > b->value; };
+				storage.sort<Tracked, decltype(descending), true>(module, descending);
+				CHECK(storage.get<Tracked>(0).entity == h);
+				storage.sort_monotonic<Tracked>(module);
+				CHECK(storage.get<Tracked>(0).entity == h);
+				CHECK(module.get_component<Tracked>(other.index()).value == 3);
+				module.release_entity(other);
+			}
+
+			CHECK(module.release_entity(h));
+			CHECK(module.valid(h) == false);
+			CHECK(module.release_entity(h) == false); // Stale handles can't release the entity which reused their slot
+
+			ecrs::Handle h2 = module.create_handle();
+			CHECK(h2.index() == h.index());
+			CHECK(h2 != h);
+			CHECK(module.valid(h2));
+			CHECK(module.valid(h) == false);
+			CHECK(ecrs::Entity{h2}.handle(module) == h2);
+			// module.should_leak = true; // Don't bother cleaning up after ourselves...
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
+
 	TEST_CASE("ecrs::UniqueTag") {
 #ifdef FP_ENABLE_BENCHMARKING
 		ankerl::nanobench::Bench().run("ecrs::UniqueTag", []{
@@ -262,24 +499,458 @@ TEST_SUITE("ECS") {
 		FP_FRAME_MARK;
 	}
 
-	// TEST_CASE("ecrs::Query") {
-	// 	ZoneScoped;
-	// 	ecrs::module module;
-	// 	*module.add_component<float>(module.create_entity()) = 1;
-	// 	*module.add_component<float>(module.create_entity()) = 2;
-	// 	*module.add_component<float>(module.create_entity()) = 3;
+	TEST_CASE("ecrs::Query") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::Query", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::Query");
+			struct Marked : public ecrs::Tag {};
+			ecrs::Module module;
+			for(size_t i = 0; i < 3; ++i) {
+				ecrs::entity_t e = module.create_entity();
+				module.add_component<float>(e) = e;
+			}
+			module.add_component<double>(2) = 20;
+			module.add_component<Marked>(3);
+
+			size_t count = 0;
+			for(auto [e, value]: ecrs::query<ecrs::include_entity, float>(module)) {
+				CHECK(e == value);
+				++count;
+			}
+			CHECK(count == 3);
 
-	// 	for(auto [e, value]: ecrs::query<ecrs::include_entity, float>(module))
-	// 		CHECK(e + 1 == value);
+			count = 0;
+			for(auto [e, value]: ecrs::query<ecrs::include_entity, std::optional<double>>(module)) {
+				if(e == 2) CHECK(*value == 20);
+				else CHECK(value == nullptr);
+				++count;
+			}
+			CHECK(count == 3);
 
-	// 	for(auto [e, value]: ecrs::query<ecrs::include_entity, std::optional<float>>(module))
-	// 		CHECK(e + 1 == *value);
+			// Driven by the (smaller) double storage
+			auto both = ecrs::query<float, double>(module);
+			CHECK(both.driver == &module.get_storage<double>());
+			count = 0;
+			both.each([&](float& f, double& d) {
+				CHECK(f == 2);
+				CHECK(d == 20);
+				++count;
+			});
+			CHECK(count == 1);
 
-	// 	for(auto [e, value]: ecrs::query<ecrs::include_entity, ecrs::or_<float, double>>(module)) {
-	// 		CHECK(e + 1 == std::get<std::reference_wrapper<float>>(value));
-	// 		REQUIRE_THROWS((void)std::get<std::reference_wrapper<double>>(value));
-	// 	}
-	// }
+			count = 0;
+			ecrs::query<ecrs::include_entity, float, ecrs::exclude<double>, ecrs::exclude<Marked>>(module).each([&](ecrs::entity_t e, float& f) {
+				CHECK(e == 1);
+				++count;
+			});
+			CHECK(count == 1);
+
+			// Only tags, visits every entity
+			count = 0;
+			ecrs::query<ecrs::include_entity, Marked>(module).each([&](ecrs::entity_t e, Marked&) {
+				CHECK(e == 3);
+				++count;
+			});
+			CHECK(count == 1);
+
+			// A required component nobody has matches nothing
+			CHECK(ecrs::query<float, int>(module).size() == 0);
+
+			// Without a driver released entities are skipped (until their slot is reused)
+			CHECK(module.release_entity(1));
+			CHECK(!module.release_entity(1)); // Already released
+			CHECK(module.is_released(1));
+			count = 0;
+			ecrs::query<ecrs::include_entity, ecrs::exclude<Marked>>(module).each([&](ecrs::entity_t e) {
+				CHECK(e == 2);
+				++count;
+			});
+			CHECK(count == 1);
+			CHECK(module.create_entity() == 1);
+			CHECK(!module.is_released(1));
+			CHECK(ecrs::query<ecrs::include_entity, ecrs::exclude<Marked>>(module).matches(1));
+			// module.should_leak = true; // Don't bother cleaning up after ourselves...
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
+
+	TEST_CASE("ecrs::TagBitset") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::TagBitset", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::TagBitset");
+			struct Red : public ecrs::Tag {};
+			struct Blue : public ecrs::Tag {};
+			ecrs::Module module;
+			ecrs::entity_t first = module.create_entities(200);
+			for(ecrs::entity_t e = first; e < first + 200; ++e) {
+				if(e % 3 == 0) module.add_component<Red>(e);
+				if(e % 5 == 0) module.add_component<Blue>(e);
+			}
+			size_t redID = ecrs::get_global_component_id<Red>();
+			CHECK(module.is_tag(redID));
+			CHECK(module.has_component<Red>(3));
+			CHECK(module.has_component(3, redID));
+			CHECK(!module.has_component<Red>(4));
+			CHECK(module.tag_count(redID) == 66);
+			CHECK(fpda_size(module.entity_component_indices[3]) <= 1); // Tags don't grow the index
+
+			size_t seen = 0;
+			ecrs::query<ecrs::include_entity, Red, Blue>(module).each([&](ecrs::entity_t e, Red&, Blue&) {
+				CHECK(e % 15 == 0);
+				++seen;
+			});
+			CHECK(seen == 13);
+			seen = 0;
+			ecrs::query<ecrs::include_entity, Blue, ecrs::exclude<Red>>(module).each([&](ecrs::entity_t e, Blue&) {
+				CHECK(e % 15 != 0);
+				++seen;
+			});
+			CHECK(seen == 40 - 13);
+
+			CHECK(module.remove_component<Red>(3));
+			CHECK(!module.has_component<Red>(3));
+			module.release_entity(6);
+			std::vector<ecrs::entity_t> dead = {9, 12};
+			module.release_entities(dead);
+			CHECK(module.tag_count(redID) == 62);
+			ecrs::entity_t reused = module.create_entity();
+			CHECK(!module.has_component<Red>(reused)); // Released entities lose their tags
+			// module.should_leak = true; // Don't bother cleaning up after ourselves...
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
+
+	TEST_CASE("ecrs::ReorderEntities") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::ReorderEntities", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::ReorderEntities");
+			struct Marked : public ecrs::Tag {};
+			ecrs::Module module;
+			ecrs::entity_t first = module.create_entities(100);
+			for(ecrs::entity_t e = first; e < first + 100; ++e) {
+				module.add_component<float>(e) = e;
+				if(e % 3 == 0) module.add_component<Marked>(e);
+			}
+			size_t markedID = ecrs::get_global_component_id<Marked>();
+			size_t count = module.tag_count(markedID);
+
+			// Reverse every entity, tags have to move along with their components
+			size_t size = module.entity_count();
+			std::vector<size_t> order(size);
+			for(size_t i = 0; i < size; ++i) order[i] = size - 1 - i;
+			module.reorder_entities(fp_view_make(size_t, order.data(), size));
+
+			bool consistent = true;
+			for(ecrs::entity_t e = first; e < first + 100; ++e) {
+				ecrs::entity_t moved = size - 1 - e;
+				consistent &= module.get_component<float>(moved) == e;
+				consistent &= module.has_component<Marked>(moved) == (e % 3 == 0);
+			}
+			CHECK(consistent);
+			CHECK(module.tag_count(markedID) == count);
+
+			module.swap_entities(1, 2);
+			CHECK(module.get_component<float>(1) == size - 3);
+			CHECK(module.has_component<Marked>(1) == ((size - 3) % 3 == 0));
+			CHECK(module.has_component<Marked>(2) == ((size - 2) % 3 == 0));
+			// module.should_leak = true; // Don't bother cleaning up after ourselves...
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
+
+	TEST_CASE("ecrs::Group") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::Group", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::Group");
+			ecrs::Module module;
+			std::array<ecrs::entity_t, 8> es;
+			for(auto& e: es) {
+				e = module.create_entity();
+				module.add_component<float>(e) = e;
+				if(e % 2) module.add_component<int>(e) = e;
+			}
+
+			size_t group = module.create_group<float, int>();
+			auto check_group = [&] {
+				size_t count = 0;
+				module.each_in_group<float, int>(group, [&](ecrs::entity_t e, float& f, int& i) {
+					CHECK(f == e);
+					CHECK(ecrs::entity_t(i) == e);
+					CHECK(module.has_component<int>(e));
+					++count;
+				});
+				CHECK(count == module.group_size(group));
+				// Ungrouped entities sit after the group
+				auto& storage = module.get_storage<float>();
+				for(size_t i = module.group_size(group); i < storage.size(); ++i)
+					CHECK(!module.has_component<int>(storage.entities[i]));
+			};
+			CHECK(module.group_size(group) == 4);
+			check_group();
+
+			module.add_component<int>(es[1]) = es[1];
+			CHECK(module.group_size(group) == 5);
+			CHECK(ecrs::entity_t(module.get_component<int>(es[1])) == es[1]);
+			check_group();
+
+			module.remove_component<float>(es[0]);
+			CHECK(module.group_size(group) == 4);
+			check_group();
+
+			module.release_entity(es[2]);
+			CHECK(module.group_size(group) == 3);
+			check_group();
+
+			module.make_all_monotonic(); // Skips the grouped storages
+			check_group();
+			// module.should_leak = true; // Don't bother cleaning up after ourselves...
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
+
+	TEST_CASE("ecrs::Bulk") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::Bulk", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::Bulk");
+			struct Tagged : public ecrs::Tag {};
+			ecrs::Module module;
+			ecrs::entity_t first = module.create_entities(1000);
+			CHECK(first == 1); // Entity zero is skipped
+			CHECK(module.entity_count() == 1001);
+			CHECK(module.create_entity() == 1001);
+
+			std::vector<ecrs::entity_t> entities(1000);
+			std::iota(entities.begin(), entities.end(), first);
+			std::vector<float> values(1000);
+			std::iota(values.begin(), values.end(), 0);
+			module.add_components<float>(entities, values);
+			module.add_components<int>(std::span<const ecrs::entity_t>(entities).subspan(0, 10));
+			module.add_components<Tagged>(std::span<const ecrs::entity_t>(entities).subspan(0, 2));
+
+			CHECK(module.get_storage<float>().size() == 1000);
+			for(size_t i = 0; i < entities.size(); ++i)
+				CHECK(module.get_component<float>(entities[i]) == i);
+			CHECK(module.get_storage<int>().size() == 10);
+			CHECK(module.get_component<int>(entities[9]) == 0);
+			CHECK(module.has_component<Tagged>(entities[1]));
+			CHECK(!module.has_component<Tagged>(entities[2]));
+
+			CHECK(module.remove_component<float>(entities[0]));
+			CHECK(module.get_component<float>(entities[999]) == 999);
+			// module.should_leak = true; // Don't bother cleaning up after ourselves...
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
+
+	TEST_CASE("ecrs::ReleaseEntities") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::ReleaseEntities", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::ReleaseEntities");
+			ecrs::Module module;
+			ecrs::entity_t first = module.create_entities(100);
+			for(ecrs::entity_t e = first; e < first + 100; ++e) {
+				module.add_component<float>(e) = e;
+				if(e % 3 == 0) module.add_component<int>(e) = e;
+				if(e % 5 == 0) module.add_component<double>(e) = e;
+			}
+			size_t group = module.create_group<float, int>();
+			ecrs::Handle kept = module.handle(first + 1), released = module.handle(first);
+
+			std::vector<ecrs::entity_t> dead;
+			for(ecrs::entity_t e = first; e < first + 100; e += 2)
+				dead.push_back(e);
+			dead.push_back(first); // Duplicates are ignored
+			module.release_entities(dead);
+
+			CHECK(fpda_size(module.freelist) == 50);
+			CHECK(!module.valid(released));
+			CHECK(module.valid(kept));
+			CHECK(module.get_storage<float>().size() == 50);
+			CHECK(module.get_storage<int>().size() == 16);
+			CHECK(module.group_size(group) == 16);
+			module.each_in_group<float, int>(group, [](ecrs::entity_t e, float& f, int& i) {
+				CHECK(f == e);
+				CHECK(ecrs::entity_t(i) == e);
+			});
+			for(ecrs::entity_t e = first; e < first + 100; ++e) {
+				bool alive = (e - first) % 2;
+				CHECK(module.has_component<float>(e) == alive);
+				if(alive) CHECK(module.get_component<float>(e) == e);
+				if(alive && e % 5 == 0) CHECK(module.get_component<double>(e) == e);
+			}
+			// module.should_leak = true; // Don't bother cleaning up after ourselves...
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
+
+	TEST_CASE("ecrs::Chunked") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::Chunked", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::Chunked");
+			ecrs::Module module;
+			ecrs::entity_t first = module.create_entity();
+			module.add_component<float>(first) = 0;
+			auto& storage = module.get_storage<float>();
+			storage.make_chunked(16 * sizeof(float));
+			CHECK(storage.chunked());
+			CHECK(storage.chunk_size == 16);
+			float& stable = module.get_component<float>(first);
+			CHECK(stable == 0);
+
+			for(size_t i = 1; i < 100; ++i)
+				module.add_component<float>(module.create_entity()) = i;
+			CHECK(&stable == &module.get_component<float>(first)); // Growing didn't move anything
+			CHECK(storage.size() == 100);
+			CHECK(storage.chunk_count() == 7);
+			CHECK(storage.chunk<float>(6).size() == 4);
+
+			size_t seen = 0;
+			for(size_t c = 0; c < storage.chunk_count(); ++c)
+				for(float& f: storage.chunk<float>(c))
+					CHECK(f == seen++);
+			CHECK(seen == 100);
+
+			module.remove_component<float>(first);
+			CHECK(storage.size() == 99);
+			CHECK(module.get_component<float>(first + 1) == 1);
+			module.make_monotonic(ecrs::get_global_component_id<float>());
+			for(size_t i = 0; i + 1 < storage.size(); ++i)
+				CHECK(storage.entities[i] < storage.entities[i + 1]);
+			ecrs::query<ecrs::include_entity, float>(module).each([](ecrs::entity_t e, float& f) {
+				CHECK(f == e - 1);
+			});
+
+			std::vector<ecrs::entity_t> dead = {first + 1, first + 50};
+			module.release_entities(dead);
+			CHECK(storage.size() == 97);
+			CHECK(module.get_component<float>(first + 99) == 99);
+			// module.should_leak = true; // Don't bother cleaning up after ourselves...
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
+
+	TEST_CASE("ecrs::ChangeTicks") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::ChangeTicks", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::ChangeTicks");
+			ecrs::Module module;
+			module.track_changes<float>();
+			for(size_t i = 0; i < 10; ++i)
+				module.add_component<float>(module.create_entity()) = i;
+			module.add_component<int>(1) = 1;
+
+			size_t last = 0;
+			size_t seen = 0;
+			ecrs::query<ecrs::changed<float>>(module, last).each([&] { ++seen; });
+			CHECK(seen == 10); // Everything is new the first time around
+			last = module.advance_tick();
+
+			seen = 0;
+			ecrs::query<ecrs::changed<float>>(module, last).each([&] { ++seen; });
+			CHECK(seen == 0);
+
+			module.modify_component<float>(3) = 30;
+			module.get_component<float>(4) = 40; // Untracked access
+			module.add_component<float>(module.create_entity()) = 11;
+			module.remove_component<float>(1); // Moves the last element (just added) into slot zero
+			seen = 0;
+			ecrs::query<ecrs::include_entity, ecrs::changed<float>, float>(module, last).each([&](ecrs::entity_t e, float& f) {
+				CHECK((e == 3 || e == 11));
+				++seen;
+			});
+			CHECK(seen == 2);
+			seen = 0;
+			ecrs::query<ecrs::include_entity, ecrs::added<float>>(module, last).each([&](ecrs::entity_t e) {
+				CHECK(e == 11);
+				++seen;
+			});
+			CHECK(seen == 1);
+
+			// Ticks follow their elements through reordering
+			module.make_all_monotonic();
+			std::vector<ecrs::entity_t> dead = {2, 5};
+			module.release_entities(dead);
+			seen = 0;
+			ecrs::query<ecrs::include_entity, ecrs::changed<float>>(module, last).each([&](ecrs::entity_t e) {
+				CHECK((e == 3 || e == 11));
+				++seen;
+			});
+			CHECK(seen == 2);
+			// module.should_leak = true; // Don't bother cleaning up after ourselves...
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
+
+	struct Lane {
+		static constexpr size_t storage_alignment = 64;
+		float value;
+	};
+
+	TEST_CASE("ecrs::Aligned") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::Aligned", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::Aligned");
+			ecrs::Module module;
+			for(size_t i = 0; i < 100; ++i)
+				module.add_component<Lane>(module.create_entity()).value = i;
+			auto& storage = module.get_storage<Lane>();
+			CHECK(storage.alignment == 64);
+			CHECK(storage.size() == 100);
+
+			auto span = storage.aligned<Lane>();
+			CHECK((uintptr_t)span.data % 64 == 0);
+			CHECK(span.size == 100);
+			CHECK(span.padded_size == 112);
+			for(size_t i = 0; i < span.size; ++i)
+				CHECK(span[i].value == i);
+
+			module.remove_component<Lane>(1);
+			CHECK(storage.size() == 99);
+			CHECK(module.get_component<Lane>(2).value == 1);
+			module.make_monotonic(ecrs::get_global_component_id<Lane>());
+			CHECK((uintptr_t)storage.data<Lane>() % 64 == 0);
+
+			// Existing storages can be re-laid out
+			auto& floats = module.get_storage<float>();
+			for(size_t i = 1; i < 10; ++i)
+				module.add_component<float>(i) = i;
+			floats.align_to(32);
+			CHECK((uintptr_t)floats.data<float>() % 32 == 0);
+			module.add_component<float>(10) = 10;
+			CHECK((uintptr_t)floats.aligned<float>().data % 32 == 0);
+			for(size_t i = 1; i <= 10; ++i)
+				CHECK(module.get_component<float>(i) == i);
+			// module.should_leak = true; // Don't bother cleaning up after ourselves...
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
 
 	TEST_CASE("ecrs::Typed") {
 #ifdef FP_ENABLE_BENCHMARKING
@@ -299,6 +970,55 @@ TEST_SUITE("ECS") {
 		FP_FRAME_MARK;
 	}
 
+	struct Transform {
+		float x, y;
+		int layer;
+	};
+
+	TEST_CASE("ecrs::SoA") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::SoA", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::SoA");
+			static_assert(ecrs::soa::field_count_v<Transform> == 3);
+			ecrs::Module module;
+			ecrs::soa::Storage<Transform> transforms(module);
+			for(size_t i = 0; i < 10; ++i)
+				transforms.add(module.create_entity(), {float(i), float(i) * 2, int(i)});
+			CHECK(transforms.size() == 10);
+
+			Transform t = transforms.get(3);
+			CHECK(t.x == 2); CHECK(t.y == 4); CHECK(t.layer == 2);
+			auto [x, y, layer] = transforms.get(3);
+			x = 100;
+			CHECK(transforms.get(3).get<0>() == 100);
+			transforms.get(4) = Transform{1, 2, 3};
+			CHECK(module.get_component<ecrs::soa::field<Transform, 2>>(4).value == 3);
+
+			float sum = 0;
+			for(float& x: transforms.span<0>())
+				sum += x;
+			CHECK(sum == 0 + 1 + 100 + 1 + 4 + 5 + 6 + 7 + 8 + 9);
+
+			CHECK(transforms.remove(1));
+			CHECK(!transforms.has(1));
+			CHECK(transforms.size() == 9);
+			for(size_t i = 0; i < transforms.size(); ++i)
+				CHECK(ecrs::entity_t(transforms.at(i).get<2>() + 1) == transforms.entities()[i] || transforms.entities()[i] == 4);
+
+			std::vector<ecrs::entity_t> more = {module.create_entity(), module.create_entity()};
+			std::vector<Transform> values = {{1, 1, 1}, {2, 2, 2}};
+			transforms.add(more, values);
+			CHECK(transforms.get(more[1]).get<1>() == 2);
+			module.make_all_monotonic();
+			CHECK(transforms.get(5).get<2>() == 4); // Fields stay in step through monotonic sorts
+			// module.should_leak = true; // Don't bother cleaning up after ourselves...
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
+
 	TEST_CASE("ecrs::Hashtable") {
 #ifdef FP_ENABLE_BENCHMARKING
 		ankerl::nanobench::Bench().run("ecrs::Hashtable", []{
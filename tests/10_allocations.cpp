@@ -0,0 +1,261 @@
+// NOTE: Built as its own executable (tst-libecrs-allocations) since it replaces the global operator new/delete
+//  and always hooks fp dynarrays so their allocations reach the tally
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#ifndef ECRS_ENABLE_ALLOCATORS
+	#define ECRS_ENABLE_ALLOCATORS
+#endif
+#define ECRS_IMPLEMENTATION
+#include <ECRS/ecrs.hpp>
+#include <ECRS/query.hpp>
+#include <ECRS/scheduler.hpp>
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#ifdef FP_ENABLE_BENCHMARKING
+	#include <nanobench.h>
+#endif
+
+#include "../libfp/tests/profile.config.hpp"
+
+// Route operator new through the tally as well (fp dynarrays report to it themselves)
+//  NOTE: Every form is replaced so allocations and deallocations always pair up
+namespace {
+	void* tallied_allocate(size_t size, size_t alignment = 0) noexcept {
+		ecrs::AllocationTally::record(size);
+		if(alignment <= alignof(std::max_align_t)) return std::malloc(size ? size : 1);
+		return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+	}
+	void* tallied_allocate_or_throw(size_t size, size_t alignment = 0) {
+		if(void* out = tallied_allocate(size, alignment)) return out;
+		throw std::bad_alloc();
+	}
+}
+void* operator new(size_t size) { return tallied_allocate_or_throw(size); }
+void* operator new[](size_t size) { return tallied_allocate_or_throw(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return tallied_allocate_or_throw(size, size_t(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return tallied_allocate_or_throw(size, size_t(alignment)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return tallied_allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return tallied_allocate(size); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return tallied_allocate(size, size_t(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return tallied_allocate(size, size_t(alignment)); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { std::free(ptr); }
+
+namespace {
+	struct PerOperation { double allocations, bytes; };
+
+	// Runs f repetitions times and reports how much it allocated per call
+	template<typename F>
+	PerOperation allocations_per_operation(const F& f, size_t repetitions = 1000) {
+		ecrs::AllocationTally tally;
+		for(size_t i = 0; i < repetitions; ++i)
+			f(i);
+		return {double(tally.allocations) / repetitions, double(tally.bytes) / repetitions};
+	}
+
+	// Fails the test if a path declared to be allocation free touches the heap
+	#define CHECK_ZERO_ALLOCATIONS(name, ...) do {\
+			auto per_operation = allocations_per_operation(__VA_ARGS__);\
+			CHECK_MESSAGE(per_operation.allocations == 0, name " allocated " << per_operation.allocations << " times (" << per_operation.bytes << " bytes) per call");\
+		} while(0)
+}
+
+TEST_SUITE("ecrs::allocations") {
+	TEST_CASE("ecrs::allocations::Tally") {
+		FP_ZONE_SCOPED_NAMED("ecrs::allocations::Tally");
+		ecrs::AllocationTally outer;
+		{
+			ecrs::AllocationTally inner;
+			delete new int(5);
+			CHECK(inner.allocations == 1);
+			CHECK(inner.bytes == sizeof(int));
+		}
+		CHECK(outer.allocations == 0); // Only the innermost tally counts
+		delete new int(5);
+		CHECK(outer.allocations == 1);
+
+		fp_dynarray(int) array = nullptr;
+		fpda_push_back(array, 1);
+		CHECK(outer.allocations == 2);
+		fpda_free_and_null(array);
+	}
+
+	TEST_CASE("ecrs::allocations::HotPaths") {
+		FP_ZONE_SCOPED_NAMED("ecrs::allocations::HotPaths");
+		struct Marked : public ecrs::Tag {};
+		ecrs::Module module;
+		ecrs::entity_t first = module.create_entities(1000);
+		for(ecrs::entity_t e = first; e < first + 1000; ++e) {
+			module.add_component<float>(e) = e;
+			if(e % 3) module.add_component<int>(e) = -e;
+			if(e % 2) module.add_component<Marked>(e);
+		}
+
+		CHECK_ZERO_ALLOCATIONS("get_component", [&](size_t i) {
+			module.get_component<float>(first + i % 1000) += 1;
+		});
+		CHECK_ZERO_ALLOCATIONS("has_component", [&](size_t i) {
+			[[maybe_unused]] volatile bool has = module.has_component<int>(first + i % 1000) && module.has_component<Marked>(first + i % 1000);
+		});
+		CHECK_ZERO_ALLOCATIONS("query", [&](size_t) {
+			float sum = 0;
+			ecrs::query<float, int, ecrs::exclude<Marked>>(module).each([&](float& f, int& i) { sum += f + i; });
+			for(auto [e, f]: ecrs::query<ecrs::include_entity, float>(module))
+				sum += f;
+			[[maybe_unused]] volatile float result = sum;
+		}, 10);
+		CHECK_ZERO_ALLOCATIONS("query without a driver", [&](size_t) {
+			size_t count = 0;
+			ecrs::query<Marked>(module).each([&](Marked&) { ++count; });
+			[[maybe_unused]] volatile size_t result = count;
+		}, 10);
+	}
+
+#ifndef FP_DISABLE_STRING_COMPONENT_LOOKUP
+	TEST_CASE("ecrs::allocations::ComponentIdFromName") {
+		FP_ZONE_SCOPED_NAMED("ecrs::allocations::ComponentIdFromName");
+		size_t id = ecrs::ecrs_component_id_from_name("allocations::known");
+		ecrs::ecrs_component_id_from_name("allocations::known::but::longer"); // Grows the scratch buffer once
+		fp_string_view known = fp_string_to_view_const("allocations::known");
+		CHECK_ZERO_ALLOCATIONS("ecrs_component_id_from_name_view", [&](size_t) {
+			CHECK(ecrs::ecrs_component_id_from_name_view(known) == id);
+		}, 100);
+		CHECK_ZERO_ALLOCATIONS("ecrs_component_id_from_name_view (missing)", [&](size_t) {
+			CHECK(ecrs::ecrs_component_id_from_name_view(fp_string_to_view_const("allocations::missing"), false) == size_t(-1));
+		}, 100);
+	}
+#endif
+
+	TEST_CASE("ecrs::allocations::Kanren") {
+		FP_ZONE_SCOPED_NAMED("ecrs::allocations::Kanren");
+		// Goals are coroutines threading std::list substitutions, so stepping them allocates by design
+		//  This only records the cost per solution so changes to it show up in the test log
+		namespace kr = ecrs::kanren;
+		ecrs::TrivialModule module;
+		auto per_operation = allocations_per_operation([&](size_t) {
+			kr::State state{&module};
+			auto goal = kr::next_variables([](kr::Variable x) {
+				return kr::disjunction(kr::eq({x}, {ecrs::Entity{5}}), kr::eq({x}, {ecrs::Entity{6}}));
+			});
+			size_t solutions = 0;
+			for([[maybe_unused]] auto& s: goal(state)) ++solutions;
+			CHECK(solutions == 2);
+		}, 10);
+		MESSAGE("kanren: " << per_operation.allocations / 2 << " allocations (" << per_operation.bytes / 2 << " bytes) per solution");
+	}
+
+	TEST_CASE("ecrs::allocations::Hook") {
+		FP_ZONE_SCOPED_NAMED("ecrs::allocations::Hook");
+		// Every module allocator relies on libfp growing its dynarrays through FP_ALLOCATION_FUNCTION
+		ecrs::CountingAllocator counter;
+		fp_dynarray(int) array = nullptr;
+		{
+			ecrs::AllocatorScope scope(counter);
+			fpda_push_back(array, 5);
+			fpda_grow(array, 1000);
+		}
+		CHECK(counter.allocations >= 1);
+		CHECK(counter.live >= 1001 * sizeof(int));
+		fpda_free_and_null(array);
+		CHECK(counter.live == 0);
+	}
+
+	TEST_CASE("ecrs::allocations::Module") {
+		FP_ZONE_SCOPED_NAMED("ecrs::allocations::Module");
+		struct Marked : public ecrs::Tag {};
+		auto fill = [](ecrs::Module& module) {
+			for(size_t i = 0; i < 100; ++i) {
+				auto e = module.create_entity();
+				module.add_component<float>(e) = i;
+				module.add_component<int>(e) = i;
+				if(i % 2) {
+					module.add_component<double>(e) = i;
+					module.add_component<Marked>(e);
+				}
+			}
+			module.create_group<float, double>();
+			module.track_changes<float>();
+			module.release_entity(5);
+			module.get_storage<int>().make_chunked(64);
+		};
+
+		ecrs::CountingAllocator counter, elsewhere;
+		{
+			ecrs::Module module(counter);
+			ecrs::AllocatorScope scope(elsewhere); // Nothing the module grows should come from the thread's allocator
+			fill(module);
+			CHECK(counter.live > 100 * sizeof(float));
+			CHECK(elsewhere.allocations == 0);
+		}
+		CHECK(counter.live == 0); // Every allocation the module made was returned
+
+		ecrs::CountingAllocator upstream;
+		ecrs::ArenaAllocator arena(64 * 1024, upstream);
+		{
+			ecrs::Module module(arena);
+			ecrs::AllocatorScope scope(elsewhere);
+			fill(module);
+			CHECK(elsewhere.allocations == 0);
+			module.should_leak = true; // Skip the individual frees...
+		}
+		CHECK(arena.used() > 0);
+		arena.reset(); // ... and tear everything down at once
+		CHECK(upstream.live == 0);
+	}
+
+	TEST_CASE("ecrs::allocations::Relation") {
+		FP_ZONE_SCOPED_NAMED("ecrs::allocations::Relation");
+		struct Parent : public ecrs::Relation<> {};
+		// Remembers the last block it handed out, so the header written in front of it can be inspected
+		struct RecordingAllocator : public ecrs::CountingAllocator {
+			void* last = nullptr;
+			void* allocate(size_t size) noexcept override { return last = CountingAllocator::allocate(size); }
+		} counter;
+		ecrs::CountingAllocator elsewhere;
+		{
+			ecrs::RelationalModule module(counter);
+			ecrs::Entity a = module.create_entity(), b = module.create_entity(), c = module.create_entity();
+			ecrs::AllocatorScope scope(elsewhere); // The related list should still come from the module
+			auto& related = c.add_relation<Parent>(module, {a, b});
+			REQUIRE(related.size() == 2);
+			CHECK(related[1] == b);
+			CHECK(((ecrs::detail::AllocationHeader*)counter.last)->owner == &counter);
+			CHECK(elsewhere.allocations == 0);
+		}
+	}
+
+	TEST_CASE("ecrs::allocations::Scheduler") {
+		FP_ZONE_SCOPED_NAMED("ecrs::allocations::Scheduler");
+		ecrs::CountingAllocator counter;
+		{
+			ecrs::AllocatorScope scope(counter);
+			auto fill = [](ecrs::Scheduler& scheduler) {
+				scheduler.add_system<ecrs::writes<float>>("a", [](ecrs::TrivialModule&) {});
+				scheduler.add_system<ecrs::reads<float>, ecrs::writes<int>>("b", [](ecrs::TrivialModule&) {});
+				scheduler.add_system<ecrs::exclusive>("c", [](ecrs::TrivialModule&) {});
+			};
+			ecrs::Scheduler scheduler, replacement;
+			fill(scheduler);
+			fill(replacement);
+			CHECK(counter.live > 0);
+			scheduler = std::move(replacement); // The replaced systems' access and dependent lists should be freed
+			CHECK(scheduler.systems.size() == 3);
+			CHECK(scheduler.systems[2].dependency_count == 2);
+		}
+		CHECK(counter.live == 0);
+	}
+}
@@ -65,6 +65,13 @@ TEST_SUITE("ECRS") {
 				auto id = std::get<kr::Variable>(v).id;
 				std::cout << "Var " << id << " = " << e.get_component<fp::raii::string>().raw << "\n";
 			}
+
+		auto z = mod.next_logic_variable();
+		auto is_male = ecrs::has_component<male>({z});
+		size_t males = 0;
+		for(const auto& state: is_male(mod.logic_state))
+			++males;
+		CHECK(males == 3); // Tags are found through their bitsets
 	}
 
 	TEST_CASE("ecrs::type_inference") {
@@ -77,9 +77,9 @@ TEST_SUITE("ecrs::serialize") {
 		call.add_relation<arguments>() = {A, B};
 
 		fp::raii::dynarray<std::byte> bytes = ecrs::serialize::serialize<size_t, fp::raii::string, type_of, function_types, struct call, arguments>(mod);
-		CHECK(bytes.size() == 594);
+		CHECK(bytes.size() == (sizeof(ecrs::entity_t) == 8 ? 626 : 594)); // Relations store entity ids
         bytes = ecrs::serialize::serialize<uint8_t, fp::raii::string, type_of, function_types, struct call, arguments>(mod);
-		CHECK(bytes.size() == 188);
+		CHECK(bytes.size() == (sizeof(ecrs::entity_t) == 8 ? 220 : 188));
 		// {
 		// 	std::ofstream fout("dump.bin", std::ios::binary);
 		// 	fout.write((char*)bytes.data(), bytes.size());
@@ -99,4 +99,63 @@ TEST_SUITE("ecrs::serialize") {
 			CHECK(args[1] == B);
 		}
     }
+
+	TEST_CASE("tags") {
+		FP_ZONE_SCOPED_NAMED("ecrs::serialize::tags");
+		struct Marked : public ecrs::Tag {};
+		fp::raii::dynarray<std::byte> bytes;
+		{
+			ecrs::Module mod;
+			for(size_t i = 0; i < 10; ++i) {
+				ecrs::entity_t e = mod.create_entity();
+				mod.add_component<float>(e) = i;
+				if(i % 3 == 0) mod.add_component<Marked>(e);
+			}
+			bytes = ecrs::serialize::serialize<size_t, float, Marked>(mod);
+		}
+
+		ecrs::Module fresh; // Has never seen the tag
+		auto consumed = ecrs::serialize::deserialize<size_t, float, Marked>(fresh, bytes.full_view());
+		CHECK(consumed == bytes.size());
+		CHECK(fresh.is_tag(ecrs::get_global_component_id<Marked>()));
+		CHECK(fresh.tag_count(ecrs::get_global_component_id<Marked>()) == 4);
+		bool consistent = true;
+		for(ecrs::entity_t e = 1; e <= 10; ++e) {
+			consistent &= fresh.get_component<float>(e) == e - 1;
+			consistent &= fresh.has_component<Marked>(e) == ((e - 1) % 3 == 0);
+		}
+		CHECK(consistent);
+		FP_FRAME_MARK;
+	}
+
+	TEST_CASE("versions") {
+		FP_ZONE_SCOPED_NAMED("ecrs::serialize::versions");
+		fp::raii::dynarray<std::byte> bytes;
+		ecrs::Handle alive, released, stale;
+		{
+			ecrs::Module mod;
+			for(size_t i = 0; i < 4; ++i)
+				mod.add_component<float>(mod.create_entity()) = i;
+			mod.add_component<int>(1) = 5;
+			stale = mod.handle(2);
+			mod.release_entity(2);
+			alive = mod.create_handle(); // Reuses entity 2
+			released = mod.handle(3);
+			mod.release_entity(3);
+			bytes = ecrs::serialize::serialize<uint8_t, float, int>(mod);
+		}
+
+		ecrs::Module fresh;
+		auto consumed = ecrs::serialize::deserialize<uint8_t, float, int>(fresh, bytes.full_view());
+		CHECK(consumed == bytes.size());
+		CHECK(!fresh.valid(ecrs::invalid_handle));
+		CHECK(fresh.valid(alive));
+		CHECK(!fresh.valid(stale));
+		CHECK(!fresh.valid(released));
+		CHECK(fresh.is_released(released.index()));
+		CHECK(!fresh.is_released(alive.index()));
+		CHECK(fresh.get_component<float>(1) == 0);
+		CHECK(fresh.create_entity() == released.index()); // Released entities can be reused
+		FP_FRAME_MARK;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include <doctest/doctest.h>
+
+#include <ECRS/sparse.hpp>
+
+#ifdef FP_ENABLE_BENCHMARKING
+	#include <nanobench.h>
+#endif
+
+#include "../libfp/tests/profile.config.hpp"
+
+TEST_SUITE("ecrs::sparse") {
+	TEST_CASE("ecrs::sparse::Basic") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::sparse::Basic", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::sparse::Basic");
+			ecrs::sparse::Module module;
+			ecrs::entity_t e = module.create_entity();
+			CHECK(e == 1);
+			CHECK((module.add_component<float>(e) = 5) == 5);
+			CHECK(module.get_component<float>(e) == 5);
+			CHECK(module.has_component<float>(e) == true);
+			CHECK(module.has_component<int>(e) == false);
+
+			ecrs::entity_t e2 = module.create_entity();
+			CHECK(e2 == 2);
+			CHECK((module.add_component<float>(e2) = 6) == 6);
+			CHECK(module.get_component<float>(e) == 5);
+
+			struct tag : public ecrs::Tag {};
+			module.add_component<tag>(e2);
+			CHECK(module.has_component<tag>(e2) == true);
+			CHECK(module.has_component<tag>(e) == false);
+			CHECK(module.remove_component<tag>(e2) == true);
+			CHECK(module.has_component<tag>(e2) == false);
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
+
+	TEST_CASE("ecrs::sparse::Removal") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::sparse::Removal", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::sparse::Removal");
+			ecrs::sparse::Module module;
+			for(size_t i = 0; i < 2000; ++i)
+				module.create_entity();
+			// Only entities in the first and last page should cause index pages to be allocated
+			module.add_component<float>(1) = 1;
+			module.add_component<float>(2) = 2;
+			module.add_component<float>(1999) = 1999;
+			CHECK(module.get_index(ecrs::get_global_component_id<float>()).allocated_pages() == 2);
+
+			CHECK(module.remove_component<float>(1) == true);
+			CHECK(module.remove_component<float>(1) == false);
+			CHECK(module.get_component<float>(2) == 2);
+			CHECK(module.get_component<float>(1999) == 1999);
+			CHECK(module.get_storage<float>().size() == 2);
+
+			CHECK(module.release_entity(2));
+			CHECK(module.has_component<float>(2) == false);
+			CHECK(module.get_component<float>(1999) == 1999);
+			CHECK(module.create_entity() == 2);
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
+}
@@ -0,0 +1,120 @@
+#include <doctest/doctest.h>
+
+#include <ECRS/archetype.hpp>
+
+#ifdef FP_ENABLE_BENCHMARKING
+	#include <nanobench.h>
+#endif
+
+#include "../libfp/tests/profile.config.hpp"
+
+TEST_SUITE("ecrs::archetype") {
+	TEST_CASE("ecrs::archetype::Basic") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::archetype::Basic", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::archetype::Basic");
+			ecrs::archetype::Module module;
+			ecrs::entity_t e = module.create_entity();
+			CHECK(e == 1);
+			CHECK((module.add_component<float>(e) = 5) == 5);
+			CHECK((module.add_component<int>(e) = 6) == 6);
+			CHECK(module.get_component<float>(e) == 5);
+			CHECK(module.get_component<int>(e) == 6);
+			CHECK(module.has_component<double>(e) == false);
+
+			ecrs::entity_t e2 = module.create_entity();
+			module.add_component<int>(e2) = 7;
+			module.add_component<float>(e2) = 8;
+			CHECK(module.archetype_count() == 4); // {}, {float}, {float, int}, {int}
+			CHECK(module.get_component<float>(e2) == 8);
+
+			CHECK(module.remove_component<float>(e) == true);
+			CHECK(module.remove_component<float>(e) == false);
+			CHECK(module.has_component<float>(e) == false);
+			CHECK(module.get_component<int>(e) == 6);
+			CHECK(module.get_component<float>(e2) == 8);
+			CHECK(module.get_component<int>(e2) == 7);
+			CHECK(module.archetype_count() == 4); // Removal reuses the cached edge back to {int}
+
+			struct tag : public ecrs::Tag {};
+			module.add_component<tag>(e2);
+			CHECK(module.has_component<tag>(e2) == true);
+			CHECK(module.get_component<int>(e2) == 7);
+
+			CHECK(module.release_entity(e));
+			CHECK(module.get_component<int>(e2) == 7);
+			CHECK(module.create_entity() == e);
+			CHECK(module.has_component<int>(e) == false);
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
+
+	TEST_CASE("ecrs::archetype::ForEach") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::archetype::ForEach", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::archetype::ForEach");
+			ecrs::archetype::Module module;
+			for(size_t i = 0; i < 100; ++i) {
+				auto e = module.create_entity();
+				module.add_component<float>(e) = e;
+				if(i % 2) module.add_component<int>(e) = e;
+				if(i % 3) module.add_component<double>(e) = e;
+			}
+
+			size_t count = 0;
+			module.for_each<float, int>([&](ecrs::entity_t e, float& f, int& i) {
+				CHECK(f == e);
+				CHECK(ecrs::entity_t(i) == e);
+				++count;
+			});
+			CHECK(count == 50);
+
+			count = 0;
+			module.for_each<int, double>([&](ecrs::entity_t e, int& i, double& d) { ++count; });
+			CHECK(count == 33);
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
+
+	struct Lane {
+		static constexpr size_t storage_alignment = 64;
+		float value;
+	};
+
+	TEST_CASE("ecrs::archetype::Aligned") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::archetype::Aligned", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::archetype::Aligned");
+			ecrs::archetype::Module module;
+			for(size_t i = 0; i < 100; ++i) {
+				auto e = module.create_entity();
+				module.add_component<Lane>(e).value = e;
+				if(i % 2) module.add_component<int>(e) = e;
+			}
+
+			auto lane = ecrs::get_global_component_id<Lane>();
+			size_t columns = 0;
+			for(size_t a = 0; a < module.archetype_count(); ++a) {
+				auto& archetype = module.archetypes[a];
+				if(size_t column = archetype.column(lane); column != ecrs::Storage::invalid) {
+					auto& storage = archetype.columns[column];
+					CHECK(storage.alignment == 64);
+					CHECK((uintptr_t)storage.aligned<Lane>().data % 64 == 0);
+					++columns;
+				}
+			}
+			CHECK(columns == 2); // {Lane}, {int, Lane}
+			module.for_each<Lane>([](ecrs::entity_t e, Lane& l) { CHECK(l.value == e); });
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
+}
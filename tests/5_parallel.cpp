@@ -0,0 +1,130 @@
+#include <doctest/doctest.h>
+
+#include <ECRS/parallel.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#ifdef FP_ENABLE_BENCHMARKING
+	#include <nanobench.h>
+#endif
+
+#include "../libfp/tests/profile.config.hpp"
+
+TEST_SUITE("ecrs::parallel") {
+	TEST_CASE("ecrs::parallel::ThreadPool") {
+		FP_ZONE_SCOPED_NAMED("ecrs::parallel::ThreadPool");
+		ecrs::parallel::ThreadPool pool(3);
+		CHECK(pool.thread_count() == 4);
+
+		std::atomic<size_t> sum = 0;
+		ecrs::parallel::for_each_chunk(10000, [&](size_t begin, size_t end) {
+			size_t local = 0;
+			for(size_t i = begin; i < end; ++i) local += i;
+			sum += local;
+		}, 100, pool);
+		CHECK(sum == 10000 * 9999 / 2);
+	}
+
+	TEST_CASE("ecrs::parallel::Storage") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::parallel::Storage", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::parallel::Storage");
+			ecrs::Module module;
+			for(size_t i = 0; i < 5000; ++i)
+				module.add_component<float>(module.create_entity()) = i;
+
+			ecrs::parallel::for_each<float>(module, [](float& f) { f *= 2; });
+			auto& storage = module.get_storage<float>();
+			for(size_t i = 0; i < storage.size(); ++i)
+				CHECK(storage.get<float>(i) == i * 2);
+
+			ecrs::parallel::for_each<float>(module, [](ecrs::entity_t e, float& f) { f = e; });
+			for(size_t i = 0; i < storage.size(); ++i)
+				CHECK(storage.get<float>(i) == storage.entities[i]);
+			CHECK(!module.structurally_locked());
+			// module.should_leak = true; // Don't bother cleaning up after ourselves...
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
+
+	TEST_CASE("ecrs::parallel::Query") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::parallel::Query", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::parallel::Query");
+			ecrs::Module module;
+			for(size_t i = 0; i < 5000; ++i) {
+				ecrs::entity_t e = module.create_entity();
+				module.add_component<float>(e) = i;
+				if(i % 3 == 0) module.add_component<int>(e) = 1;
+			}
+
+			std::atomic<size_t> count = 0, locked = 0;
+			ecrs::parallel::for_each(ecrs::query<ecrs::include_entity, float, int>(module), [&](ecrs::entity_t e, float& f, int& i) {
+				if(module.structurally_locked()) ++locked;
+				f = -1;
+				++count;
+			});
+			CHECK(count == 1667);
+			CHECK(locked == count);
+			ecrs::query<float, std::optional<int>>(module).each([](float& f, int* i) {
+				CHECK((f == -1) == (i != nullptr));
+			});
+			// module.should_leak = true; // Don't bother cleaning up after ourselves...
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
+
+	TEST_CASE("ecrs::parallel::Sort") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::parallel::Sort", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::parallel::Sort");
+			ecrs::parallel::ThreadPool pool(3);
+			{ // Runs which don't divide evenly leave an odd run out of some merge rounds
+				std::vector<size_t> values(10007), scratch(values.size());
+				for(size_t i = 0; i < values.size(); ++i) values[i] = i * 7919 % values.size();
+				ecrs::parallel::sort(values.data(), values.size(), std::less<size_t>{}, scratch.data(), 1000, pool);
+				bool identity = true; // The values are a permutation of [0, size) so sorting them gives the identity
+				for(size_t i = 0; i < values.size(); ++i) identity &= values[i] == i;
+				CHECK(identity);
+			}
+
+			ecrs::Module module;
+			constexpr size_t count = 50000;
+			ecrs::entity_t first = module.create_entities(count);
+			for(size_t i = 0; i < count; ++i) {
+				ecrs::entity_t e = first + i * 7919 % count; // Added out of entity order
+				module.add_component<float>(e) = -float(e);
+				if(e % 3) module.add_component<int>(e) = e;
+			}
+			auto consistent = [&] {
+				bool out = true;
+				for(ecrs::entity_t e = first; e < first + count; ++e)
+					out &= module.get_component<float>(e) == -float(e) && (e % 3 == 0 || module.get_component<int>(e) == int(e));
+				return out;
+			};
+
+			ecrs::parallel::sort<float>(module, [](float* a, float* b) { return *a < *b; }, 4096, pool);
+			auto& storage = module.get_storage<float>();
+			CHECK(std::is_sorted(storage.data<float>(), storage.data<float>() + storage.size()));
+			CHECK(consistent());
+
+			ecrs::parallel::make_all_monotonic(module, pool);
+			for(auto* storage: {&module.get_storage<float>(), &module.get_storage<int>()})
+				CHECK(std::is_sorted(storage->entities, storage->entities + storage->size()));
+			CHECK(consistent());
+			CHECK(!module.structurally_locked());
+			// module.should_leak = true; // Don't bother cleaning up after ourselves...
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
+}
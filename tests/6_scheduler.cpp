@@ -0,0 +1,84 @@
+#include <doctest/doctest.h>
+
+#include <ECRS/scheduler.hpp>
+
+#ifdef FP_ENABLE_BENCHMARKING
+	#include <nanobench.h>
+#endif
+
+#include "../libfp/tests/profile.config.hpp"
+
+TEST_SUITE("ecrs::scheduler") {
+	TEST_CASE("ecrs::scheduler::Dependencies") {
+		FP_ZONE_SCOPED_NAMED("ecrs::scheduler::Dependencies");
+		ecrs::Scheduler scheduler;
+		size_t a = scheduler.add_system<ecrs::writes<float>>("a", [](ecrs::TrivialModule&) {});
+		size_t b = scheduler.add_system<ecrs::reads<float>, ecrs::writes<int>>("b", [](ecrs::TrivialModule&) {});
+		size_t c = scheduler.add_system<ecrs::reads<float>>("c", [](ecrs::TrivialModule&) {});
+		size_t d = scheduler.add_system<ecrs::reads<double>>("d", [](ecrs::TrivialModule&) {});
+		size_t e = scheduler.add_system<ecrs::exclusive>("e", [](ecrs::TrivialModule&) {});
+
+		CHECK(scheduler.systems[a].dependency_count == 0);
+		CHECK(scheduler.systems[b].dependency_count == 1);
+		CHECK(scheduler.systems[c].dependency_count == 1); // Reads don't conflict with each other
+		CHECK(scheduler.systems[d].dependency_count == 0);
+		CHECK(scheduler.systems[e].dependency_count == 4);
+		CHECK(scheduler.find("c") == c);
+		CHECK(scheduler.find("missing") == ecrs::Scheduler::invalid);
+	}
+
+	TEST_CASE("ecrs::scheduler::Run") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::scheduler::Run", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::scheduler::Run");
+			ecrs::Module module;
+			for(size_t i = 0; i < 1000; ++i) {
+				ecrs::entity_t e = module.create_entity();
+				module.add_component<float>(e) = 0;
+				module.add_component<int>(e) = 0;
+			}
+
+			using namespace std::chrono_literals;
+			ecrs::parallel::ThreadPool pool(3);
+			ecrs::Scheduler scheduler;
+			scheduler.add_system<ecrs::writes<float>>("integrate", [](ecrs::TrivialModule& module) {
+				std::this_thread::sleep_for(2ms);
+				ecrs::parallel::for_each<float>(module, [](float& f) { f += 1; });
+			});
+			scheduler.add_system<ecrs::reads<float>, ecrs::writes<int>>("copy", [](ecrs::TrivialModule& module) {
+				std::this_thread::sleep_for(2ms);
+				ecrs::query<float, int>(module).each([](float& f, int& i) { i = f; });
+			});
+			std::atomic<size_t> spawned = 0;
+			scheduler.add_system<ecrs::reads<double>>("unrelated", [&](ecrs::TrivialModule&) { ++spawned; });
+			scheduler.add_system<ecrs::exclusive>("spawn", [&](ecrs::TrivialModule& module) {
+				module.add_component<int>(module.create_entity()) = -1;
+			});
+
+			scheduler.run(module, pool);
+			scheduler.run(module, pool);
+			CHECK(spawned == 2);
+			size_t ones = 0;
+			ecrs::query<float, int>(module).each([&](float& f, int& i) {
+				CHECK(i == f);
+				++ones;
+			});
+			CHECK(ones == 1000);
+			CHECK(module.get_storage<int>().size() == 1002);
+
+			std::chrono::steady_clock::duration total;
+			auto path = scheduler.critical_path(&total);
+			REQUIRE(path.size() == 3);
+			CHECK(scheduler.systems[path[0]].name == "integrate");
+			CHECK(scheduler.systems[path[1]].name == "copy");
+			CHECK(scheduler.systems[path[2]].name == "spawn");
+			CHECK(total >= 4ms);
+			CHECK(scheduler.last_run_duration >= total);
+			// module.should_leak = true; // Don't bother cleaning up after ourselves...
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
+}
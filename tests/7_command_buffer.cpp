@@ -0,0 +1,114 @@
+#include <doctest/doctest.h>
+
+#include <ECRS/command_buffer.hpp>
+#include <ECRS/query.hpp>
+
+#ifdef FP_ENABLE_BENCHMARKING
+	#include <nanobench.h>
+#endif
+
+#include "../libfp/tests/profile.config.hpp"
+
+TEST_SUITE("ecrs::command_buffer") {
+	TEST_CASE("ecrs::CommandBuffer") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::CommandBuffer", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::CommandBuffer");
+			struct Dead : public ecrs::Tag {};
+			ecrs::Module module;
+			for(size_t i = 0; i < 10; ++i)
+				module.add_component<float>(module.create_entity()) = i;
+
+			// Record changes while iterating
+			ecrs::CommandBuffer commands;
+			ecrs::query<ecrs::include_entity, float>(module).each([&](ecrs::entity_t e, float& f) {
+				if(int(f) % 2) commands.remove_component<float>(e);
+				else commands.add_component<int>(e, f * 10);
+				if(f == 4) commands.add_component<Dead>(e);
+				if(f == 8) commands.release_entity(e);
+			});
+			ecrs::entity_t placeholder = commands.create_entity();
+			CHECK(ecrs::CommandBuffer::is_placeholder(placeholder));
+			commands.add_component<float>(placeholder, 100);
+			commands.add_component<int>(placeholder, 1000);
+			CHECK(module.get_storage<float>().size() == 10); // Nothing has been applied yet
+
+			commands.flush(module);
+			CHECK(commands.empty());
+			ecrs::entity_t created = commands.resolve(placeholder);
+			CHECK(!ecrs::CommandBuffer::is_placeholder(created));
+			CHECK(module.get_component<float>(created) == 100);
+			CHECK(module.get_component<int>(created) == 1000);
+
+			CHECK(module.get_storage<float>().size() == 5 - 1 + 1); // Odd values removed, 8 released, one created
+			CHECK(module.get_storage<int>().size() == 4 + 1);
+			size_t count = 0;
+			ecrs::query<float, int>(module).each([&](float& f, int& i) {
+				CHECK(i == f * 10);
+				++count;
+			});
+			CHECK(count == 5);
+			CHECK(ecrs::query<Dead>(module).size() > 0);
+			ecrs::query<ecrs::include_entity, Dead, float>(module).each([](ecrs::entity_t, Dead&, float& f) {
+				CHECK(f == 4);
+			});
+
+			// Removing a tag and replacing an existing component's value
+			commands.remove_component<Dead>(5);
+			commands.add_component<float>(created, 7);
+			commands.flush(module);
+			CHECK(!module.has_component<Dead>(5));
+			CHECK(module.get_component<float>(created) == 7);
+			CHECK(module.get_storage<float>().size() == 5);
+			// module.should_leak = true; // Don't bother cleaning up after ourselves...
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
+
+	TEST_CASE("ecrs::CommandBuffer::Ordering") {
+#ifdef FP_ENABLE_BENCHMARKING
+		ankerl::nanobench::Bench().run("ecrs::CommandBuffer::Ordering", []{
+#endif
+			FP_ZONE_SCOPED_NAMED("ecrs::CommandBuffer::Ordering");
+			struct alignas(64) Wide { float value; };
+			ecrs::Module module;
+			ecrs::entity_t a = module.create_entity(), b = module.create_entity();
+			module.add_component<float>(a) = 1;
+
+			// The last add or remove recorded for an entity wins
+			ecrs::CommandBuffer commands;
+			commands.remove_component<float>(a);
+			commands.add_component<float>(a, 2);
+			commands.add_component<float>(b, 3);
+			commands.remove_component<float>(b);
+			CHECK(commands.flush(module) == 0);
+			CHECK(module.get_component<float>(a) == 2);
+			CHECK(!module.has_component<float>(b));
+
+			// Placeholders from before the last flush are rejected
+			ecrs::entity_t placeholder = commands.create_entity();
+			commands.flush(module);
+			CHECK(commands.resolve(placeholder) != ecrs::invalid_entity);
+			commands.add_component<float>(placeholder, 4);
+			commands.add_component<float>(b, 5);
+			CHECK(commands.flush(module) == 1);
+			CHECK(commands.resolve(placeholder) == ecrs::invalid_entity);
+			CHECK(module.get_storage<float>().size() == 2);
+			CHECK(module.get_component<float>(b) == 5);
+
+			// Untyped adds still create the storage with the component's alignment
+			Wide wide{6};
+			commands.add_component(a, ecrs::get_global_component_id<Wide>(), sizeof(Wide), &wide, ecrs::storage_alignment_v<Wide>);
+			commands.flush(module);
+			CHECK(module.get_component<Wide>(a).value == 6);
+			CHECK((uintptr_t)&module.get_component<Wide>(a) % alignof(Wide) == 0);
+			// module.should_leak = true; // Don't bother cleaning up after ourselves...
+#ifdef FP_ENABLE_BENCHMARKING
+		});
+#endif
+		FP_FRAME_MARK;
+	}
+}
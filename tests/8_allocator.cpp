@@ -0,0 +1,38 @@
+#include <doctest/doctest.h>
+
+#include <ECRS/ecs.hpp>
+
+#ifdef FP_ENABLE_BENCHMARKING
+	#include <nanobench.h>
+#endif
+
+#include "../libfp/tests/profile.config.hpp"
+
+TEST_SUITE("ecrs::allocator") {
+	TEST_CASE("ecrs::allocator::Reallocate") {
+		FP_ZONE_SCOPED_NAMED("ecrs::allocator::Reallocate");
+		ecrs::CountingAllocator counter;
+		ecrs::ArenaAllocator arena(256, counter);
+		void* outside = nullptr;
+		{
+			ecrs::AllocatorScope scope(arena);
+			CHECK(&ecrs::current_allocator() == &arena);
+			outside = ecrs::reallocate(nullptr, 32);
+			std::memset(outside, 7, 32);
+			CHECK(counter.allocations == 1);
+		}
+		CHECK(&ecrs::current_allocator() == &ecrs::HeapAllocator::instance());
+
+		// Growing outside of the scope still comes from the arena
+		outside = ecrs::reallocate(outside, 512);
+		CHECK(((uint8_t*)outside)[31] == 7);
+		CHECK(counter.allocations == 2); // Didn't fit in the first block
+		CHECK(arena.used() >= 512);
+		CHECK(ecrs::reallocate(outside, 0) == nullptr); // No-op for arenas
+
+		arena.reset();
+		CHECK(arena.used() == 0);
+		CHECK(counter.live == 0);
+		CHECK(counter.peak > 512);
+	}
+}
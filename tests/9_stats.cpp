@@ -0,0 +1,104 @@
+#include <doctest/doctest.h>
+
+#include <ECRS/stats.hpp>
+
+#ifdef FP_ENABLE_BENCHMARKING
+	#include <nanobench.h>
+#endif
+
+#include "../libfp/tests/profile.config.hpp"
+
+TEST_SUITE("ecrs::stats") {
+	TEST_CASE("ecrs::stats::Module") {
+		FP_ZONE_SCOPED_NAMED("ecrs::stats::Module");
+		struct Marked : public ecrs::Tag {};
+		ecrs::Module module;
+		ecrs::entity_t first = module.create_entities(100);
+		for(ecrs::entity_t e = first; e < first + 100; ++e) {
+			module.add_component<float>(e) = e;
+			if(e % 2) module.add_component<Marked>(e);
+		}
+		module.release_entity(first);
+
+		ecrs::ModuleStats stats;
+		ecrs::collect_stats(module, stats);
+		CHECK(stats.entity_count == 101);
+		CHECK(stats.freelist_size == 1);
+		CHECK(stats.index_bytes >= 100 * sizeof(ecrs::index_t));
+
+		auto floats = stats.find<float>();
+		REQUIRE(floats);
+		CHECK(floats->element_size == sizeof(float));
+		CHECK(floats->count == 99);
+		CHECK(floats->capacity >= 99);
+		CHECK(floats->bytes_reserved >= 99 * (sizeof(float) + sizeof(ecrs::entity_t)));
+		CHECK(floats->bytes_wasted == floats->bytes_reserved - 99 * (sizeof(float) + sizeof(ecrs::entity_t)));
+
+		auto marked = stats.find<Marked>();
+		REQUIRE(marked);
+		CHECK(marked->element_size == 0);
+		CHECK(marked->count == 49);
+		CHECK(marked->capacity >= 101);
+		CHECK(stats.total_bytes > floats->bytes_reserved + marked->bytes_reserved + stats.index_bytes);
+
+		// Sampling again reuses the same buffer
+		auto components = stats.components;
+		ecrs::collect_stats(module, stats);
+		CHECK(stats.components == components);
+	}
+
+	TEST_CASE("ecrs::stats::Relations") {
+		FP_ZONE_SCOPED_NAMED("ecrs::stats::Relations");
+		struct children : public ecrs::Relation<> {};
+		ecrs::RelationalModule module;
+		ecrs::entity_t parent = module.create_entity();
+		auto& related = module.add_relation<children>(parent);
+		related = {{module.create_entity()}, {module.create_entity()}, {module.create_entity()}};
+
+		auto stats = ecrs::stats(module);
+		CHECK(stats.relation_payload_bytes >= 3 * sizeof(ecrs::Entity));
+		CHECK(stats.total_bytes >= stats.relation_payload_bytes);
+	}
+
+	TEST_CASE("ecrs::profiling::Counters") {
+		FP_ZONE_SCOPED_NAMED("ecrs::profiling::Counters");
+		using ecrs::profiling::Counter;
+		ecrs::Module module;
+		ecrs::entity_t e = module.create_entity();
+		ecrs::profiling::reset();
+		module.add_component<float>(e) = 1;
+		module.add_component<int>(e) = 2;
+		module.remove_component<int>(e);
+
+#ifdef ECRS_ENABLE_PROFILING
+		CHECK(ecrs::profiling::count(Counter::ComponentAdds) == 2);
+		CHECK(ecrs::profiling::count(Counter::ComponentRemoves) == 1);
+		ecrs::profiling::reset();
+		CHECK(ecrs::profiling::count(Counter::ComponentAdds) == 0);
+#else
+		CHECK(ecrs::profiling::count(Counter::ComponentAdds) == 0);
+		CHECK(ecrs::profiling::count(Counter::ComponentRemoves) == 0);
+#endif
+	}
+
+	TEST_CASE("ecrs::profiling::GoalSteps") {
+		FP_ZONE_SCOPED_NAMED("ecrs::profiling::GoalSteps");
+		using ecrs::profiling::Counter;
+		ecrs::RelationalModule module;
+		for(size_t i = 0; i < 3; ++i)
+			module.add_component<float>(module.create_entity()) = i;
+		auto x = module.next_logic_variable();
+		auto goal = ecrs::has_component<float>({x});
+		ecrs::profiling::reset();
+		size_t found = 0;
+		for(const auto& state: goal(module.logic_state))
+			++found;
+		CHECK(found == 3);
+
+#ifdef ECRS_ENABLE_PROFILING
+		CHECK(ecrs::profiling::count(Counter::GoalSteps) == 1);
+#else
+		CHECK(ecrs::profiling::count(Counter::GoalSteps) == 0);
+#endif
+	}
+}
\ No newline at end of file